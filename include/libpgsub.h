@@ -17,6 +17,14 @@
 #define CONFIG_ALGO_OPT_ENABLED 1
 #endif
 
+/**
+ * @brief Determines whether the OPT algorithm with a bounded lookahead is enabled
+ * @details Default is enabled.
+ */
+#ifndef CONFIG_ALGO_OPT_WINDOW_ENABLED
+#define CONFIG_ALGO_OPT_WINDOW_ENABLED 1
+#endif
+
 #ifndef CONFIG_ALGO_FIFO_ENABLED
 #define CONFIG_ALGO_FIFO_ENABLED 1
 #endif
@@ -29,6 +37,94 @@
 #define CONFIG_ALGO_CLOCK_ENABLED 1
 #endif
 
+/**
+ * @brief Determines whether the Adaptive Replacement Cache (ARC) algorithm is enabled
+ * @details Default is enabled.
+ */
+#ifndef CONFIG_ALGO_ARC_ENABLED
+#define CONFIG_ALGO_ARC_ENABLED 1
+#endif
+
+/**
+ * @brief Determines whether the LIRS algorithm is enabled
+ * @details Default is enabled.
+ */
+#ifndef CONFIG_ALGO_LIRS_ENABLED
+#define CONFIG_ALGO_LIRS_ENABLED 1
+#endif
+
+/**
+ * @brief Determines whether the CLOCK-Pro algorithm is enabled
+ * @details Default is enabled.
+ */
+#ifndef CONFIG_ALGO_CLOCKPRO_ENABLED
+#define CONFIG_ALGO_CLOCKPRO_ENABLED 1
+#endif
+
+/**
+ * @brief Determines whether the 2Q algorithm is enabled
+ * @details Default is enabled.
+ */
+#ifndef CONFIG_ALGO_2Q_ENABLED
+#define CONFIG_ALGO_2Q_ENABLED 1
+#endif
+
+/**
+ * @brief Determines whether the Segmented LRU (SLRU) algorithm is enabled
+ * @details Default is enabled.
+ */
+#ifndef CONFIG_ALGO_SLRU_ENABLED
+#define CONFIG_ALGO_SLRU_ENABLED 1
+#endif
+
+/**
+ * @brief Determines whether the Least Frequently Used (LFU) algorithm is enabled
+ * @details Default is enabled.
+ */
+#ifndef CONFIG_ALGO_LFU_ENABLED
+#define CONFIG_ALGO_LFU_ENABLED 1
+#endif
+
+/**
+ * @brief Determines whether the WSClock algorithm is enabled
+ * @details Default is enabled.
+ */
+#ifndef CONFIG_ALGO_WSCLOCK_ENABLED
+#define CONFIG_ALGO_WSCLOCK_ENABLED 1
+#endif
+
+/**
+ * @brief Determines whether the Aging algorithm is enabled
+ * @details Default is enabled.
+ */
+#ifndef CONFIG_ALGO_AGING_ENABLED
+#define CONFIG_ALGO_AGING_ENABLED 1
+#endif
+
+/**
+ * @brief Determines whether the LRU-K algorithm is enabled
+ * @details Default is enabled.
+ */
+#ifndef CONFIG_ALGO_LRUK_ENABLED
+#define CONFIG_ALGO_LRUK_ENABLED 1
+#endif
+
+/**
+ * @brief Determines whether the sampled approximate LRU algorithm is enabled
+ * @details Default is enabled.
+ */
+#ifndef CONFIG_ALGO_SAMPLED_LRU_ENABLED
+#define CONFIG_ALGO_SAMPLED_LRU_ENABLED 1
+#endif
+
+/**
+ * @brief Determines whether the single-pass LRU miss-ratio curve is enabled
+ * @details Default is enabled.
+ */
+#ifndef CONFIG_ANALYSIS_LRU_STACK_ENABLED
+#define CONFIG_ANALYSIS_LRU_STACK_ENABLED 1
+#endif
+
 
 // Include algorithms
 
@@ -36,6 +132,10 @@
 #include "libpgsub/algo/OPT.hpp"
 #endif
 
+#if CONFIG_ALGO_OPT_WINDOW_ENABLED
+#include "libpgsub/algo/OPTWindow.hpp"
+#endif
+
 #if CONFIG_ALGO_FIFO_ENABLED
 #include "libpgsub/algo/FIFO.hpp"
 #endif
@@ -48,6 +148,52 @@
 #include "libpgsub/algo/Clock.hpp"
 #endif
 
+#if CONFIG_ALGO_ARC_ENABLED
+#include "libpgsub/algo/ARC.hpp"
+#endif
+
+#if CONFIG_ALGO_LIRS_ENABLED
+#include "libpgsub/algo/LIRS.hpp"
+#endif
+
+#if CONFIG_ALGO_CLOCKPRO_ENABLED
+#include "libpgsub/algo/ClockPro.hpp"
+#endif
+
+#if CONFIG_ALGO_2Q_ENABLED
+#include "libpgsub/algo/2Q.hpp"
+#endif
+
+#if CONFIG_ALGO_SLRU_ENABLED
+#include "libpgsub/algo/SLRU.hpp"
+#endif
+
+#if CONFIG_ALGO_LFU_ENABLED
+#include "libpgsub/algo/LFU.hpp"
+#endif
+
+#if CONFIG_ALGO_WSCLOCK_ENABLED
+#include "libpgsub/algo/WSClock.hpp"
+#endif
+
+#if CONFIG_ALGO_AGING_ENABLED
+#include "libpgsub/algo/Aging.hpp"
+#endif
+
+#if CONFIG_ALGO_LRUK_ENABLED
+#include "libpgsub/algo/LRUK.hpp"
+#endif
+
+#if CONFIG_ALGO_SAMPLED_LRU_ENABLED
+#include "libpgsub/algo/SampledLRU.hpp"
+#endif
+
+// Include analysis
+
+#if CONFIG_ANALYSIS_LRU_STACK_ENABLED
+#include "libpgsub/analysis/LRUStack.hpp"
+#endif
+
 // Include simulation
 
 
@@ -3,8 +3,23 @@
 #include "macro.h"
 #include "types.h"
 
+#if CONFIG_WITH_EXCEPTIONS
+#include "Exceptions.h"
+#include <string>
+#endif
+
 PGSUB_NAMESPACE_BEGIN
 
+/**
+ * @brief Result of an access.
+ * @details PageFault means the page is not loaded; for an algorithm, that the fault was resolved by loading it.
+ */
+enum class AccessStatus : uint8_t {
+    Hit,
+    PageFault,
+    Violation,
+};
+
 // enum VPageType{
 //     VPageType_4K,
 //     VPageType_2M,
@@ -31,11 +46,37 @@ public:
 
     /**
      * @brief Access a page.
-     * @details In real hardware, the function is used to check the page table and raise a further detail exception on the permission and so on
+     * @details In real hardware, the function is used to check the page table and report the fault on the permission and so on
      * @param vpn Virtual memory page to be accessed.
      * @param access_type Type of access. It can be a combination of PF_READ, PF_WRITE, PF_EXEC.
+     * @return AccessStatus Hit, PageFault if the page is not loaded, or Violation.
+     */
+    virtual AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) = 0;
+
+#if CONFIG_WITH_EXCEPTIONS
+    /**
+     * @brief Access a page, throwing on fault.
+     * @details Wrapper of tryAccess() for the exception based API.
+     * @throw PageFaultNotLoaded The page is not loaded, by the type of access.
+     * @throw PageFaultAccessViolation The access is not permitted.
      */
-    virtual void access(const pgidx_t& vpn, pf_t access_type) = 0;
+    void access(const pgidx_t& vpn, pf_t access_type)
+    {
+        switch (tryAccess(vpn, access_type)) {
+        case AccessStatus::Hit:
+            return;
+        case AccessStatus::PageFault:
+            if (access_type & PF_WRITE) {
+                throw PageFaultWriteNotLoaded(std::to_string(vpn));
+            } else if (access_type & PF_READ) {
+                throw PageFaultReadNotLoaded(std::to_string(vpn));
+            }
+            throw PageFaultExecNotLoaded(std::to_string(vpn));
+        case AccessStatus::Violation:
+            throw PageFaultAccessViolation(std::to_string(vpn));
+        }
+    }
+#endif
 
     /**
      * @brief Load a page of virtual memory into physical memory.
@@ -26,6 +26,7 @@ public:
 PGSUB_EXCEPTION_HELPER(PageFaultReadNotLoaded, PageFaultNotLoaded, "Page Fault - Read Not Loaded: ");
 PGSUB_EXCEPTION_HELPER(PageFaultWriteNotLoaded, PageFaultNotLoaded, "Page Fault - Write Not Loaded");
 PGSUB_EXCEPTION_HELPER(PageFaultExecNotLoaded, PageFaultNotLoaded, "Page Fault - Exec Not Loaded: ");
+PGSUB_EXCEPTION_HELPER(PageFaultAccessViolation, std::runtime_error, "Page Fault - Access Violation: ");
 
 PGSUB_EXCEPTION_HELPER(SimulateFaultStepNotSync, std::runtime_error, "Simulate Fault - Step Not Sync: ");
 PGSUB_EXCEPTION_HELPER(SimulateFaultStepOutOfBound, std::runtime_error, "Simulate Fault - Step Out Of Bound: ");
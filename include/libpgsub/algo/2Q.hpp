@@ -0,0 +1,172 @@
+/**
+ * @file 2Q.hpp
+ * @author your name (you@domain.com)
+ * @brief 2Q algorithm implementation.
+ * @version 0.1
+ * @date 2024-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @details 2Q (Johnson and Shasha) loads a page first into A1in, a FIFO, and only gives it a place in Am, an LRU list,
+ * when it is accessed again after leaving A1in: the pages evicted from A1in are remembered in A1out, a FIFO of VPNs only.
+ * A page accessed once, like one of a scan, never reaches Am. The hits in A1in count as the same (correlated) reference.
+ * The three lists are intrusive linked lists over VPN sharing one pair of link arrays, so every operation is O(1).
+ */
+
+#pragma once
+
+#include "../types.h"
+#include "../Exceptions.h"
+#include "Base.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+PGSUB_NAMESPACE_BEGIN
+
+template <typename Memory = AbstractMemory>
+class Algo2Q final : public AlgoBaseT<Memory> {
+private:
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    enum List : uint8_t {
+        A1IN,
+        A1OUT,
+        AM,
+        NONE,
+    };
+
+    pgidx_t _num_vpages;
+    size_t _kin; // Size of A1in beyond which it gives up a frame
+    size_t _kout; // Size of A1out
+    size_t _size[3] = { 0, 0, 0 };
+
+    // Links over VPN, slot _num_vpages + l is the sentinel of list l: its next is the newest page, its prev the oldest one
+    std::vector<pgidx_t> _prev;
+    std::vector<pgidx_t> _next;
+    std::vector<List> _list; // VPN -> List
+
+public:
+    /**
+     * @brief Construct a new 2Q object
+     *
+     * @param memory Pointer to Impl of AbstractMemory object
+     * @param num_vpages Number of pages of VIRTUAL memory
+     * @param kin Size of A1in, as a fraction of the number of physical pages.
+     * @param kout Size of A1out, as a fraction of the number of physical pages.
+     */
+    Algo2Q(Memory* memory, const pgidx_t& num_vpages, double kin = 0.25, double kout = 0.5)
+        : AlgoBaseT<Memory>(memory)
+        , _num_vpages(num_vpages)
+        , _kin(std::max<size_t>(size_t(memory->getNumPPages() * kin), 1))
+        , _kout(std::max<size_t>(size_t(memory->getNumPPages() * kout), 1))
+        , _prev(num_vpages + NONE)
+        , _next(num_vpages + NONE)
+        , _list(num_vpages, NONE)
+    {
+        for (int l = A1IN; l < NONE; ++l) {
+            _prev[_nil(List(l))] = _next[_nil(List(l))] = _nil(List(l));
+        }
+    }
+
+    ~Algo2Q() = default;
+
+    AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) override
+    {
+        if (vpn >= _num_vpages) {
+            PGSUB_THROW(SimulateFaultInvalidVPN(std::to_string(vpn)));
+        }
+        auto ret = _memory->tryAccess(vpn, access_type);
+        if (ret == AccessStatus::Hit) {
+            if (_list[vpn] == AM) {
+                _move(vpn, AM);
+            }
+        } else if (ret == AccessStatus::PageFault) {
+            _fault(vpn);
+            ret = _retry(vpn, access_type);
+        }
+        return ret;
+    }
+
+    // A repeated page is already the newest of Am, or still in A1in
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(this, seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpage, access_type, count);
+    }
+
+    /**
+     * @brief Get the number of resident pages in Am.
+     */
+    size_t getNumHot() const { return _size[AM]; }
+
+private:
+    void _fault(const pgidx_t& vpn)
+    {
+        // Taken out of A1out before a frame is reclaimed, so trimming A1out can neither drop it nor count it
+        bool in_out = _list[vpn] == A1OUT;
+        if (in_out) {
+            _unlink(vpn);
+        }
+        pgidx_t ppn = _memory->getFreePPage();
+        pgidx_t victim = INVALID_PAGE;
+        if (ppn == INVALID_PAGE) {
+            if (_size[A1IN] > _kin || _size[AM] == 0) {
+                victim = _oldest(A1IN);
+                if (victim == _nil(A1IN)) {
+                    PGSUB_THROW(std::runtime_error("[x] No page to evict"));
+                }
+                _move(victim, A1OUT);
+                if (_size[A1OUT] > _kout) {
+                    _unlink(_oldest(A1OUT));
+                }
+            } else {
+                victim = _oldest(AM);
+                _unlink(victim);
+            }
+            ppn = _memory->getPPage(victim);
+            _num_evictions++;
+        }
+        _memory->load(vpn, ppn, victim);
+        // Seen again after leaving A1in, so it is not a correlated reference
+        _move(vpn, in_out ? AM : A1IN);
+    }
+
+    pgidx_t _nil(List l) const { return _num_vpages + l; }
+
+    pgidx_t _oldest(List l) const { return _prev[_nil(l)]; }
+
+    void _unlink(const pgidx_t& vpn)
+    {
+        _next[_prev[vpn]] = _next[vpn];
+        _prev[_next[vpn]] = _prev[vpn];
+        _size[_list[vpn]]--;
+        _list[vpn] = NONE;
+    }
+
+    // Unlink from the current list, if any, and push as the newest page of l
+    void _move(const pgidx_t& vpn, List l)
+    {
+        if (_list[vpn] != NONE) {
+            _unlink(vpn);
+        }
+        auto nil = _nil(l);
+        _prev[vpn] = nil;
+        _next[vpn] = _next[nil];
+        _prev[_next[nil]] = vpn;
+        _next[nil] = vpn;
+        _list[vpn] = l;
+        _size[l]++;
+    }
+};
+
+PGSUB_NAMESPACE_END
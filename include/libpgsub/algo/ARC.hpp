@@ -0,0 +1,223 @@
+/**
+ * @file ARC.hpp
+ * @author your name (you@domain.com)
+ * @brief Adaptive Replacement Cache (ARC) algorithm implementation.
+ * @version 0.1
+ * @date 2024-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @details ARC (Megiddo and Modha) splits the resident pages into T1, seen once recently, and T2, seen at least twice,
+ * and remembers the pages just evicted from them in the ghost lists B1 and B2. A hit in a ghost list moves the target
+ * size p of T1 towards the list that would have kept the page, so the cache adapts between recency and frequency.
+ * A one-pass scan only flows through T1 and cannot flush the pages of T2.
+ * The four lists are intrusive doubly linked lists over VPN sharing one pair of link arrays, so every operation is O(1)
+ * and a hit costs the same as one of AlgoLRU.
+ */
+
+#pragma once
+
+#include "../types.h"
+#include "../Exceptions.h"
+#include "Base.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+PGSUB_NAMESPACE_BEGIN
+
+template <typename Memory = AbstractMemory>
+class AlgoARC final : public AlgoBaseT<Memory> {
+private:
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    enum List : uint8_t {
+        T1,
+        T2,
+        B1,
+        B2,
+        NONE,
+    };
+
+    pgidx_t _num_vpages;
+    size_t _c; // Number of physical pages
+    size_t _p = 0; // Target size of T1
+    size_t _size[4] = { 0, 0, 0, 0 };
+
+    // Links over VPN, slot _num_vpages + l is the sentinel of list l: its next is the MRU page, its prev the LRU one
+    std::vector<pgidx_t> _prev;
+    std::vector<pgidx_t> _next;
+    std::vector<List> _list; // VPN -> List
+
+public:
+    /**
+     * @brief Construct a new ARC object
+     *
+     * @param memory Pointer to Impl of AbstractMemory object
+     * @param num_vpages Number of pages of VIRTUAL memory
+     */
+    AlgoARC(Memory* memory, const pgidx_t& num_vpages)
+        : AlgoBaseT<Memory>(memory)
+        , _num_vpages(num_vpages)
+        , _c(memory->getNumPPages())
+        , _prev(num_vpages + NONE)
+        , _next(num_vpages + NONE)
+        , _list(num_vpages, NONE)
+    {
+        for (int l = T1; l < NONE; ++l) {
+            _prev[_nil(List(l))] = _next[_nil(List(l))] = _nil(List(l));
+        }
+    }
+
+    ~AlgoARC() = default;
+
+    AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) override
+    {
+        if (vpn >= _num_vpages) {
+            PGSUB_THROW(SimulateFaultInvalidVPN(std::to_string(vpn)));
+        }
+        auto ret = _memory->tryAccess(vpn, access_type);
+        if (ret == AccessStatus::Hit) {
+            // Case I: seen twice, to the MRU end of T2
+            _move(vpn, T2);
+        } else if (ret == AccessStatus::PageFault) {
+            _fault(vpn);
+            ret = _retry(vpn, access_type);
+        }
+        return ret;
+    }
+
+    // The first repeat promotes the page to T2, the next ones leave it at the MRU end
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(this, seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpage, access_type, count);
+    }
+
+    /**
+     * @brief Get the current target size of T1.
+     */
+    size_t getTarget() const { return _p; }
+
+    /**
+     * @brief Get the number of resident pages seen only once recently (T1).
+     */
+    size_t getRecentSize() const { return _size[T1]; }
+
+    /**
+     * @brief Get the number of resident pages seen at least twice recently (T2).
+     */
+    size_t getFrequentSize() const { return _size[T2]; }
+
+private:
+    // A repeated hit still has to promote a page of T1
+    AccessStatus _accessRepeat(const pgidx_t& vpn, pf_t access_type)
+    {
+        return tryAccess(vpn, access_type);
+    }
+
+    void _fault(const pgidx_t& vpn)
+    {
+        pgidx_t ppn = _memory->getFreePPage();
+        pgidx_t victim = INVALID_PAGE;
+        auto full = [&]() { return ppn == INVALID_PAGE && victim == INVALID_PAGE; };
+        switch (_list[vpn]) {
+        case B1:
+            // Case II: T1 was too small
+            _p = std::min(_c, _p + std::max<size_t>(_size[B2] / _size[B1], 1));
+            if (full()) {
+                victim = _replace(false);
+            }
+            _move(vpn, T2);
+            break;
+        case B2:
+            // Case III: T2 was too small
+            _p -= std::min(_p, std::max<size_t>(_size[B1] / _size[B2], 1));
+            if (full()) {
+                victim = _replace(true);
+            }
+            _move(vpn, T2);
+            break;
+        default:
+            // Case IV: not seen recently
+            if (_size[T1] + _size[B1] == _c) {
+                if (_size[T1] < _c) {
+                    _unlink(_lru(B1));
+                    if (full()) {
+                        victim = _replace(false);
+                    }
+                } else if (full()) {
+                    // B1 is empty and T1 fills the memory, the LRU page of T1 leaves without a ghost
+                    victim = _lru(T1);
+                    _unlink(victim);
+                }
+            } else if (_size[T1] + _size[T2] + _size[B1] + _size[B2] >= _c) {
+                if (_size[T1] + _size[T2] + _size[B1] + _size[B2] == 2 * _c) {
+                    _unlink(_lru(B2));
+                }
+                if (full()) {
+                    victim = _replace(false);
+                }
+            }
+            _move(vpn, T1);
+            break;
+        }
+        if (ppn == INVALID_PAGE) {
+            if (victim == INVALID_PAGE) {
+                PGSUB_THROW(std::runtime_error("[x] No page to evict"));
+            }
+            ppn = _memory->getPPage(victim);
+            _num_evictions++;
+        }
+        _memory->load(vpn, ppn, victim);
+    }
+
+    // Evict the LRU page of T1 or T2 into its ghost list, by the target size of T1
+    pgidx_t _replace(bool in_b2)
+    {
+        List from = _size[T1] > 0 && (_size[T1] > _p || (in_b2 && _size[T1] == _p)) ? T1 : T2;
+        if (_size[from] == 0) {
+            from = from == T1 ? T2 : T1;
+        }
+        auto victim = _lru(from);
+        _move(victim, from == T1 ? B1 : B2);
+        return victim;
+    }
+
+    pgidx_t _nil(List l) const { return _num_vpages + l; }
+
+    pgidx_t _lru(List l) const { return _prev[_nil(l)]; }
+
+    void _unlink(const pgidx_t& vpn)
+    {
+        _next[_prev[vpn]] = _next[vpn];
+        _prev[_next[vpn]] = _prev[vpn];
+        _size[_list[vpn]]--;
+        _list[vpn] = NONE;
+    }
+
+    // Unlink from the current list, if any, and push to the MRU end of l
+    void _move(const pgidx_t& vpn, List l)
+    {
+        if (_list[vpn] != NONE) {
+            _unlink(vpn);
+        }
+        auto nil = _nil(l);
+        _prev[vpn] = nil;
+        _next[vpn] = _next[nil];
+        _prev[_next[nil]] = vpn;
+        _next[nil] = vpn;
+        _list[vpn] = l;
+        _size[l]++;
+    }
+};
+
+PGSUB_NAMESPACE_END
@@ -0,0 +1,188 @@
+/**
+ * @file Aging.hpp
+ * @author your name (you@domain.com)
+ * @brief Aging (NFU with shift registers) algorithm implementation.
+ * @version 0.1
+ * @date 2024-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @details Every frame has an age register of the width of Age. On each tick, every tick_period accesses, the
+ * reference bits are harvested from PF_ACCESSED of the page table and cleared, and every register is shifted right
+ * with the bit of its frame put on top. The victim is the frame with the smallest register, the one least used in
+ * the last ticks, so the order is close to LRU while a hit only costs the memory setting the bit.
+ * The harvest goes through the memory one page at a time, so it fills a contiguous array of bits first; the shift,
+ * and the minimum of the victim search, are then branch-free passes over contiguous arrays the compiler vectorizes
+ * in an optimized build (CMAKE_BUILD_TYPE=Release, the tree sets no default).
+ * Ties go to the first frame from a hand which moves past each victim, as in Clock.
+ * The reference bit is PF_ACCESSED of the page table, set by writes too.
+ * A loaded page starts with the top bit set, as if referenced in the last tick, so it is not the next victim before
+ * a tick saw it; a reference before the next tick still adds its own bit.
+ */
+
+#pragma once
+
+#include "../types.h"
+#include "../Exceptions.h"
+#include "Base.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+PGSUB_NAMESPACE_BEGIN
+
+template <typename Memory = AbstractMemory, typename Age = uint8_t>
+class AlgoAging final : public AlgoBaseT<Memory> {
+private:
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_referenceWrite;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    static_assert(std::is_unsigned_v<Age>, "Age must be an unsigned integer type");
+    static constexpr Age TOP = Age(Age(1) << (std::numeric_limits<Age>::digits - 1));
+
+    size_t _tick_period;
+    size_t _until_tick;
+    size_t _num_ticks = 0;
+    size_t _hand = 0;
+    size_t _num_slots = 0; // Frames loaded so far
+
+    std::vector<pgidx_t> _slot_vpn; // Slot -> VPN
+    std::vector<pgidx_t> _slot_ppn; // Slot -> PPN
+    std::vector<Age> _age; // Slot -> Age register
+    std::vector<Age> _ref; // Slot -> Reference bit harvested by the tick, at the top bit
+
+public:
+    /**
+     * @brief Construct a new Aging object
+     *
+     * @param memory Pointer to Impl of AbstractMemory object
+     * @param tick_period Number of accesses between two ticks, 0 for the number of physical pages.
+     */
+    AlgoAging(Memory* memory, size_t tick_period = 0)
+        : AlgoBaseT<Memory>(memory)
+        , _tick_period(tick_period ? tick_period : memory->getNumPPages())
+        , _until_tick(_tick_period)
+        , _slot_vpn(memory->getNumPPages(), INVALID_PAGE)
+        , _slot_ppn(memory->getNumPPages(), INVALID_PAGE)
+        , _age(memory->getNumPPages(), 0)
+        , _ref(memory->getNumPPages(), 0)
+    {
+    }
+
+    ~AlgoAging() = default;
+
+    AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) override
+    {
+        auto ret = _memory->tryAccess(vpn, access_type);
+        if (ret == AccessStatus::Violation) {
+            return ret;
+        }
+        if (ret == AccessStatus::Hit) {
+            _referenceWrite(vpn, access_type);
+        } else {
+            _fault(vpn);
+            ret = _retry(vpn, access_type);
+            if (ret != AccessStatus::Violation) {
+                // Already counted in the register
+                _memory->setVFlag(vpn, _memory->getVFlag(vpn) & ~PF_ACCESSED);
+            }
+        }
+        if (--_until_tick == 0) {
+            _tick();
+            _until_tick = _tick_period;
+        }
+        return ret;
+    }
+
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(this, seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpage, access_type, count);
+    }
+
+    /**
+     * @brief Get the number of ticks so far.
+     */
+    size_t getNumTicks() const { return _num_ticks; }
+
+private:
+    static constexpr bool _repeat_idempotent = false;
+
+    // Every access counts toward the next tick
+    AccessStatus _accessRepeat(const pgidx_t& vpn, pf_t access_type)
+    {
+        return tryAccess(vpn, access_type);
+    }
+
+    void _fault(const pgidx_t& vpn)
+    {
+        size_t slot;
+        pgidx_t victim = INVALID_PAGE;
+        pgidx_t ppn = _memory->getFreePPage();
+        if (ppn != INVALID_PAGE) {
+            slot = _num_slots++;
+            _slot_ppn[slot] = ppn;
+        } else {
+            if (_num_slots == 0) {
+                PGSUB_THROW(std::runtime_error("[x] No page to evict"));
+            }
+            slot = _selectVictim();
+            ppn = _slot_ppn[slot];
+            victim = _slot_vpn[slot];
+            _num_evictions++;
+            _hand = slot + 1 == _num_slots ? 0 : slot + 1;
+        }
+        _memory->load(vpn, ppn, victim);
+        _slot_vpn[slot] = vpn;
+        _age[slot] = TOP;
+    }
+
+    void _tick()
+    {
+        auto n = _num_slots;
+        for (size_t i = 0; i < n; ++i) {
+            auto vpn = _slot_vpn[i];
+            auto flag = _memory->getVFlag(vpn);
+            if (flag & PF_ACCESSED) {
+                _memory->setVFlag(vpn, flag & ~PF_ACCESSED);
+                _ref[i] = TOP;
+            } else {
+                _ref[i] = 0;
+            }
+        }
+        Age* age = _age.data();
+        const Age* ref = _ref.data();
+        for (size_t i = 0; i < n; ++i) {
+            age[i] = Age(age[i] >> 1) | ref[i];
+        }
+        _num_ticks++;
+    }
+
+    // The first slot from the hand with the smallest register
+    size_t _selectVictim() const
+    {
+        auto n = _num_slots;
+        const Age* age = _age.data();
+        Age min = std::numeric_limits<Age>::max();
+        for (size_t i = 0; i < n; ++i) {
+            min = age[i] < min ? age[i] : min;
+        }
+        auto it = std::find(age + _hand, age + n, min);
+        if (it == age + n) {
+            it = std::find(age, age + _hand, min);
+        }
+        return it - age;
+    }
+};
+
+PGSUB_NAMESPACE_END
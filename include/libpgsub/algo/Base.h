@@ -5,32 +5,232 @@
 
 PGSUB_NAMESPACE_BEGIN
 
+/**
+ * @brief Aggregated result of a batch of accesses.
+ */
+struct AccessStats {
+    size_t hits = 0;
+    size_t faults = 0;
+    size_t evictions = 0;
+    size_t violations = 0;
+};
+
+/**
+ * @brief Type-erased interface of all algorithms.
+ * @details Algorithms are templates on the memory type (see AlgoBaseT), and all of them can be driven through this class.
+ */
 class AlgoBase {
+public:
+    AlgoBase() = default;
+    virtual ~AlgoBase() = default;
+
+    /**
+     * @brief Mark a page as accessed with a specific access type.
+     * @details In real haredware, the function is invoked from ESR of PageFault.
+     * @param vpage Virtual page to be accessed.
+     * @param access_type Access type. It can be a combination of PF_ACCESSED, PF_DIRTY
+     * @return AccessStatus Hit, PageFault if the page had to be loaded, or Violation.
+     */
+    virtual AccessStatus tryAccess(const pgidx_t& vpage, pf_t access_type) = 0;
+
+#if CONFIG_WITH_EXCEPTIONS
+    /**
+     * @brief Wrapper of tryAccess() for the exception based API.
+     * @throw PageFaultAccessViolation The access is not permitted.
+     */
+    void access(const pgidx_t& vpage, pf_t access_type)
+    {
+        if (tryAccess(vpage, access_type) == AccessStatus::Violation) {
+            throw PageFaultAccessViolation(std::to_string(vpage));
+        }
+    }
+#endif
+
+    /**
+     * @brief Access a contiguous chunk of a trace.
+     *
+     * @param seq Accesses to be replayed in order.
+     * @return AccessStats Counts of hits, faults, evictions and violations of the chunk.
+     */
+    virtual AccessStats accessBatch(AccessSpan_t seq)
+    {
+        AccessStats ret;
+        auto evictions = _num_evictions;
+        for (auto& acc : seq) {
+            _count(ret, tryAccess(acc.first, acc.second));
+        }
+        ret.evictions = _num_evictions - evictions;
+        return ret;
+    }
+
+    /**
+     * @brief Access the same page several times in a row.
+     * @details A run of a compressed trace is replayed with one call. After the first access the page is resident,
+     * so the rest of the run is a burst of hits which most algorithms take at the cost of one.
+     *
+     * @param vpage Virtual page to be accessed.
+     * @param access_type Access type of every access of the run.
+     * @param count Length of the run.
+     * @return AccessStats Counts of hits, faults, evictions and violations of the run.
+     */
+    virtual AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count)
+    {
+        AccessStats ret;
+        auto evictions = _num_evictions;
+        for (size_t i = 0; i < count; ++i) {
+            _count(ret, tryAccess(vpage, access_type));
+        }
+        ret.evictions = _num_evictions - evictions;
+        return ret;
+    }
+
+    /**
+     * @brief Give upcoming accesses to an algorithm that looks ahead.
+     * @details Algorithms without a lookahead take nothing. Accesses taken are still to be accessed in order.
+     *
+     * @param seq Accesses following the ones already taken.
+     * @return size_t Number of accesses taken from the front of seq.
+     */
+    virtual size_t lookahead(AccessSpan_t) { return 0; }
+
+    /**
+     * @brief Finish the accesses held back by accessBatch() or accessRun().
+     * @details Only algorithms with a lookahead hold accesses back, the others return nothing.
+     *
+     * @return AccessStats Counts of the accesses finished.
+     */
+    virtual AccessStats flush() { return {}; }
+
+    /**
+     * @brief Get the number of faults that needed an eviction.
+     */
+    size_t getNumEvictions() const { return _num_evictions; }
 
 protected:
-    AbstractMemory* _memory;
+    size_t _num_evictions = 0;
+
+    static void _count(AccessStats& stats, AccessStatus status)
+    {
+        switch (status) {
+        case AccessStatus::Hit:
+            stats.hits++;
+            break;
+        case AccessStatus::PageFault:
+            stats.faults++;
+            break;
+        case AccessStatus::Violation:
+            stats.violations++;
+            break;
+        }
+    }
+};
+
+/**
+ * @brief Base of algorithms bound to a memory type.
+ * @details Memory is the concrete memory class (with the same members as AbstractMemory). When it is a final class,
+ * every call into the memory is direct and can be inlined; the default AbstractMemory keeps the fully virtual path.
+ * @tparam Memory Type of memory.
+ */
+template <typename Memory = AbstractMemory>
+class AlgoBaseT : public AlgoBase {
+protected:
+    Memory* _memory;
 
 public:
+    using memory_type = Memory;
+
     /**
      * @brief Construct a new Page Sub Algo Base object
-     * 
+     *
      * @param memory Pointer to Impl of AbstractMemory object
-     * @param num_pages Number of pages of PHYSICAL memory
      */
-    AlgoBase(AbstractMemory* memory)
+    AlgoBaseT(Memory* memory)
         : _memory(memory)
     {
     }
 
-    virtual ~AlgoBase() = default;
+protected:
+    // Access again after the page was loaded on a fault
+    AccessStatus _retry(const pgidx_t& vpage, pf_t access_type)
+    {
+        auto ret = _memory->tryAccess(vpage, access_type);
+        return ret == AccessStatus::Hit ? AccessStatus::PageFault : ret;
+    }
 
     /**
-     * @brief Mark a page as accessed with a specific access type.
-     * @details In real haredware, the function is invoked from ESR of PageFault.
-     * @param vpage Virtual page to be accessed.
-     * @param access_type Access type. It can be a combination of PF_ACCESSED, PF_DIRTY
+     * @brief Make a write hit count as a reference.
+     * @details The memory sets PF_ACCESSED on a read hit and only PF_DIRTY on a write hit. An MMU sets both bits on a
+     * write, so algorithms taking PF_ACCESSED as their reference bit call this on every hit.
      */
-    virtual void access(const pgidx_t& vpage, pf_t access_type) = 0;
+    void _referenceWrite(const pgidx_t& vpage, pf_t access_type)
+    {
+        if (access_type & PF_WRITE) {
+            auto flag = _memory->getVFlag(vpage);
+            if ((flag & PF_ACCESSED) == 0) {
+                _memory->setVFlag(vpage, flag | PF_ACCESSED);
+            }
+        }
+    }
+
+    // Access a page which was just accessed, so it is still resident. Algorithms whose state changes on every hit hide this.
+    AccessStatus _accessRepeat(const pgidx_t& vpage, pf_t access_type)
+    {
+        return _memory->tryAccess(vpage, access_type);
+    }
+
+    // Whether repeating an identical access changes nothing after the first repeat. Algorithms counting every step hide this.
+    static constexpr bool _repeat_idempotent = true;
+
+    /**
+     * @brief Tight loop of accessBatch() for the algorithm Self.
+     * @details Calls are resolved on Self (which is final), so nothing in the loop is virtual.
+     * A run of accesses to the same page only takes Self::_accessRepeat(), without touching the victim selection.
+     */
+    template <typename Self>
+    AccessStats _accessBatch(Self* self, AccessSpan_t seq)
+    {
+        AccessStats ret;
+        auto evictions = this->_num_evictions;
+        for (size_t i = 0; i < seq.size();) {
+            auto vpn = seq[i].first;
+            auto status = self->tryAccess(vpn, seq[i].second);
+            this->_count(ret, status);
+            ++i;
+            if (status == AccessStatus::Violation) {
+                continue;
+            }
+            for (; i < seq.size() && seq[i].first == vpn; ++i) {
+                this->_count(ret, self->_accessRepeat(vpn, seq[i].second));
+            }
+        }
+        ret.evictions = this->_num_evictions - evictions;
+        return ret;
+    }
+
+    /**
+     * @brief accessRun() for the algorithm Self.
+     * @details Once a repeat hits, the rest of the run is counted as hits without touching the memory again,
+     * unless idempotent is false. It is Self::_repeat_idempotent by default, an algorithm whose repeats only matter
+     * in some configurations passes it at run time.
+     */
+    template <typename Self>
+    AccessStats _accessRun(Self* self, const pgidx_t& vpage, pf_t access_type, size_t count, bool idempotent = Self::_repeat_idempotent)
+    {
+        AccessStats ret;
+        auto evictions = this->_num_evictions;
+        bool resident = false;
+        for (size_t i = 0; i < count; ++i) {
+            auto status = resident ? self->_accessRepeat(vpage, access_type) : self->tryAccess(vpage, access_type);
+            this->_count(ret, status);
+            if (resident && status == AccessStatus::Hit && idempotent) {
+                ret.hits += count - i - 1;
+                break;
+            }
+            resident = status != AccessStatus::Violation;
+        }
+        ret.evictions = this->_num_evictions - evictions;
+        return ret;
+    }
 };
 
-PGSUB_NAMESPACE_END
\ No newline at end of file
+PGSUB_NAMESPACE_END
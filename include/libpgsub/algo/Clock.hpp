@@ -7,6 +7,12 @@
  *
  * @copyright Copyright (c) 2024
  *
+ * @details Frames are kept in a flat ring of slots, with the reference and dirty bits packed into bitmaps.
+ * The hand sweeps a whole 64-bit word at a time looking for the next candidate, instead of stepping
+ * node by node through the page table.
+ * The bits follow the PTE convention of AbstractMemory: a write marks the page dirty, other accesses mark it referenced.
+ * AlgoTwoHandClock splits the hand in two, a leading hand clearing the reference bits and a trailing one evicting,
+ * which bounds the travel of a fault by the spread between them.
  */
 
 #pragma once
@@ -15,148 +21,399 @@
 #include "../Exceptions.h"
 #include "Base.h"
 
-#include <forward_list>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
 
 PGSUB_NAMESPACE_BEGIN
 
-class AlgoClock : public AlgoBase {
+/**
+ * @brief Common part of the Clock family.
+ * @tparam Memory Type of memory.
+ * @tparam Derived The algorithm, which provides _selectVictim() to pick the slot to evict once memory is full.
+ */
+template <typename Memory, typename Derived>
+class AlgoClockBase : public AlgoBaseT<Memory> {
 protected:
-    template <typename T>
-    class RingList {
-    private:
-        std::forward_list<T> _list;
-        typename std::forward_list<T>::iterator _hand;
-
-    public:
-        RingList()
-            : _hand(_list.before_begin())
-        {
-        }
-
-        void insert(const T& value)
-        {
-            if(_list.empty()){
-                _hand = _list.insert_after(_hand, value);
-            }else{
-                _list.insert_after(_hand, *_hand);
-                *_hand = value;
-                next();
-            }
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    using word_t = uint64_t;
+    static constexpr size_t WORD_BITS = 64;
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    size_t _num_slots;
+    size_t _used_slots = 0;
+    size_t _hand = 0;
+
+    std::vector<pgidx_t> _slot_vpn; // Slot -> VPN
+    std::vector<pgidx_t> _slot_ppn; // Slot -> PPN
+    std::vector<size_t> _ppn_slot; // PPN -> Slot
+
+    std::vector<word_t> _ref_bits;
+    std::vector<word_t> _dirty_bits;
+
+public:
+    AlgoClockBase(Memory* memory)
+        : AlgoBaseT<Memory>(memory)
+        , _num_slots(memory->getNumPPages())
+        , _slot_vpn(_num_slots, INVALID_PAGE)
+        , _slot_ppn(_num_slots, INVALID_PAGE)
+        , _ppn_slot(_num_slots, NPOS)
+        , _ref_bits((_num_slots + WORD_BITS - 1) / WORD_BITS, 0)
+        , _dirty_bits(_ref_bits.size(), 0)
+    {
+    }
+
+    AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) override
+    {
+        auto ret = _memory->tryAccess(vpn, access_type);
+        if (ret == AccessStatus::PageFault) {
+            auto v = _process(vpn);
+            _memory->load(vpn, v.first, v.second);
+            ret = _retry(vpn, access_type);
+        }
+        if (ret != AccessStatus::Violation) {
+            _mark(_ppn_slot[_memory->getPPage(vpn)], access_type);
         }
+        return ret;
+    }
+
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(static_cast<Derived*>(this), seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpn, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(static_cast<Derived*>(this), vpn, access_type, count);
+    }
 
-        typename std::forward_list<T>::iterator begin()
-        {
-            return _list.begin();
+protected:
+    // Only the bits of the frame change on a repeated hit
+    AccessStatus _accessRepeat(const pgidx_t& vpn, pf_t access_type)
+    {
+        auto ret = _memory->tryAccess(vpn, access_type);
+        if (ret == AccessStatus::Hit) {
+            _mark(_ppn_slot[_memory->getPPage(vpn)], access_type);
         }
+        return ret;
+    }
 
-        typename std::forward_list<T>::iterator end()
-        {
-            return _list.end();
+    std::pair<pgidx_t, pgidx_t> _process(const pgidx_t& vpn)
+    {
+        size_t slot;
+        pgidx_t ppn = _memory->getFreePPage();
+        if (ppn != INVALID_PAGE) {
+            slot = _used_slots++;
+            _slot_ppn[slot] = ppn;
+            _ppn_slot[ppn] = slot;
+        } else {
+            slot = static_cast<Derived*>(this)->_selectVictim();
+            _num_evictions++;
+            _hand = slot + 1 == _num_slots ? 0 : slot + 1;
         }
+        std::pair<pgidx_t, pgidx_t> ret = { _slot_ppn[slot], _slot_vpn[slot] };
+        _slot_vpn[slot] = vpn;
+        _clearBit(_ref_bits, slot);
+        _clearBit(_dirty_bits, slot);
+        return ret;
+    }
 
-        typename std::forward_list<T>::iterator next()
-        {
-            if (_hand == _list.before_begin()) {
-                _hand = _list.begin();
-            } else {
-                ++_hand;
-                if (_hand == _list.end()) {
-                    _hand = _list.begin();
+    void _mark(size_t slot, pf_t access_type)
+    {
+        if (access_type & PF_WRITE) {
+            _setBit(_dirty_bits, slot);
+        } else {
+            _setBit(_ref_bits, slot);
+        }
+    }
+
+    /**
+     * @brief Find the first slot from the hand whose bits satisfy the predicate, one word per step.
+     *
+     * @param pred Maps (reference word, dirty word) to a word of candidate bits.
+     * @param clear_ref Whether to clear the reference bits of the slots passed by the hand.
+     * @return size_t The slot found, or NPOS if a full turn found nothing.
+     */
+    template <typename Pred>
+    size_t _sweep(Pred pred, bool clear_ref)
+    {
+        size_t num_words = _ref_bits.size();
+        size_t w = _hand / WORD_BITS, bit = _hand % WORD_BITS;
+        for (size_t k = 0; k <= num_words; ++k) {
+            size_t wi = w + k < num_words ? w + k : w + k - num_words;
+            word_t mask = _validMask(wi);
+            if (k == 0) {
+                mask &= ~word_t(0) << bit;
+            } else if (k == num_words) {
+                // Wrapped back to the first word, only the bits before the hand remain
+                mask &= (word_t(1) << bit) - 1;
+            }
+            word_t cand = pred(_ref_bits[wi], _dirty_bits[wi]) & mask;
+            if (cand) {
+                size_t pos = __builtin_ctzll(cand);
+                if (clear_ref) {
+                    _ref_bits[wi] &= ~(mask & ((word_t(1) << pos) - 1));
                 }
+                return wi * WORD_BITS + pos;
+            }
+            if (clear_ref) {
+                _ref_bits[wi] &= ~mask;
             }
-            return _hand;
         }
+        return NPOS;
+    }
 
-        typename std::forward_list<T>::iterator current()
-        {
-            return _hand;
-        }
+private:
+    word_t _validMask(size_t wi) const
+    {
+        size_t rest = _num_slots - wi * WORD_BITS;
+        return rest >= WORD_BITS ? ~word_t(0) : (word_t(1) << rest) - 1;
+    }
 
-        bool empty() const
-        {
-            return _list.empty();
-        }
+    static void _setBit(std::vector<word_t>& bits, size_t slot)
+    {
+        bits[slot / WORD_BITS] |= word_t(1) << (slot % WORD_BITS);
+    }
 
-        void reset()
-        {
-            _hand = _list.before_begin();
-        }
-    };
+    static void _clearBit(std::vector<word_t>& bits, size_t slot)
+    {
+        bits[slot / WORD_BITS] &= ~(word_t(1) << (slot % WORD_BITS));
+    }
+};
 
-    RingList<pgidx_t> _alloc_pages;
+template <typename Memory = AbstractMemory>
+class AlgoClock final : public AlgoClockBase<Memory, AlgoClock<Memory>> {
+    using Base = AlgoClockBase<Memory, AlgoClock<Memory>>;
+    friend Base;
 
 public:
-    using AlgoBase::AlgoBase;
+    AlgoClock(Memory* memory)
+        : Base(memory)
+    {
+    }
 
-    ~AlgoClock() = default;
+protected:
+    using typename Base::word_t;
+    using Base::NPOS;
+    using Base::_hand;
+    using Base::_sweep;
 
-    void access(const pgidx_t& vpn, pf_t access_type) override
+    size_t _selectVictim()
+    {
+        // Clear reference bits on the way; after one full turn every bit is clear, so the hand itself is the victim
+        auto slot = _sweep([](word_t ref, word_t) { return ~ref; }, true);
+        return slot == NPOS ? _hand : slot;
+    }
+};
+
+template <typename Memory = AbstractMemory>
+class AlgoOptClock final : public AlgoClockBase<Memory, AlgoOptClock<Memory>> {
+    using Base = AlgoClockBase<Memory, AlgoOptClock<Memory>>;
+    friend Base;
+
+public:
+    AlgoOptClock(Memory* memory)
+        : Base(memory)
     {
-        try {
-            _memory->access(vpn, access_type);
-        } catch (PageFaultNotLoaded& e) {
-            auto v = _process(vpn, access_type);
-            _memory->load(vpn, v.first, v.second);
-            _memory->access(vpn, access_type);
-        }
     }
 
 protected:
-    virtual std::pair<pgidx_t, pgidx_t> _process(const pgidx_t& vpn, pf_t access_type)
+    using typename Base::word_t;
+    using Base::NPOS;
+    using Base::_hand;
+    using Base::_sweep;
+
+    size_t _selectVictim()
     {
-        pgidx_t ppn = _memory->getFreePPage();
-        if (ppn != INVALID_PAGE) {
-            _alloc_pages.insert(vpn);
-            return { ppn, INVALID_PAGE };
-        }
-        auto c = _alloc_pages.current(), n = c;
-        for (int i = 0; i < 2; ++i) {
-            do {
-                auto pf = _memory->getVFlag(*n);
-                if ((pf & PF_ACCESSED) == 0) {
-                    std::pair<pgidx_t, pgidx_t> ret = { _memory->getPPage(*n), *n };
-                    *n = vpn;
-                    _alloc_pages.next();
-                    return ret;
-                }
-                _memory->setVFlag(*n, pf & ~PF_ACCESSED);
-                n = _alloc_pages.next();
-            } while (n != c);
+        // 1. Not referenced and clean
+        auto slot = _sweep([](word_t ref, word_t dirty) { return ~ref & ~dirty; }, false);
+        if (slot != NPOS) {
+            return slot;
+        }
+        // 2. Not referenced but dirty, clearing the reference bits on the way
+        slot = _sweep([](word_t ref, word_t dirty) { return ~ref & dirty; }, true);
+        if (slot != NPOS) {
+            return slot;
         }
-        return { INVALID_PAGE, INVALID_PAGE }; // Make compiler happy
+        // 3. Every reference bit is clear now, take the first clean one, or the hand if all are dirty
+        slot = _sweep([](word_t, word_t dirty) { return ~dirty; }, false);
+        return slot == NPOS ? _hand : slot;
     }
 };
 
-class AlgoOptClock : public AlgoClock {
+/**
+ * @brief Two-handed Clock.
+ * @details The trailing hand is the hand of the base, the leading hand is spread slots ahead of it. They move
+ * together: at each step the leading hand clears the reference bit of its slot, and the trailing hand evicts its
+ * slot if the bit is clear. A page survives if it is referenced between the two hands passing it, and since the
+ * trailing hand reaches the slots cleared during the same fault after spread steps, a fault moves the hands by at
+ * most spread + 1 slots whatever the number of referenced pages.
+ * With an advance period, every advance_period accesses the hands are moved off the fault path until the trailing
+ * hand rests on a slot not referenced, so a fault finding it still clear takes it in one step.
+ * Both hands work on whole words of the bitmap, like the hand of AlgoClock.
+ */
+template <typename Memory = AbstractMemory>
+class AlgoTwoHandClock final : public AlgoClockBase<Memory, AlgoTwoHandClock<Memory>> {
+    using Base = AlgoClockBase<Memory, AlgoTwoHandClock<Memory>>;
+    friend Base;
+    friend AlgoBaseT<Memory>;
+
 public:
-    using AlgoClock::AlgoClock;
+    /**
+     * @brief Construct a new Two-handed Clock object
+     *
+     * @param memory Pointer to Impl of AbstractMemory object
+     * @param spread Number of slots between the hands, 0 for a quarter of the physical pages. At most all but one.
+     * @param advance_period Number of accesses between two advances of the hands off the fault path, 0 to never advance.
+     */
+    AlgoTwoHandClock(Memory* memory, size_t spread = 0, size_t advance_period = 0)
+        : Base(memory)
+        , _spread(std::min(spread ? spread : std::max<size_t>(memory->getNumPPages() / 4, 1), _maxSpread(memory->getNumPPages())))
+        , _advance_period(advance_period)
+        , _until_advance(advance_period)
+    {
+    }
+
+    AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) override
+    {
+        auto ret = Base::tryAccess(vpn, access_type);
+        if (ret != AccessStatus::Violation) {
+            _tick();
+        }
+        return ret;
+    }
+
+    // Without an advance period a repeat changes nothing after the first one, so only then is the run cut short
+    AccessStats accessRun(const pgidx_t& vpn, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpn, access_type, count, _advance_period == 0);
+    }
+
+    /**
+     * @brief Get the number of slots between the hands.
+     */
+    size_t getSpread() const { return _spread; }
+
+    /**
+     * @brief Get the largest number of slots the hands moved during a fault.
+     */
+    size_t getMaxTravel() const { return _max_travel; }
+
+    /**
+     * @brief Get the number of slots the hands moved during faults.
+     */
+    size_t getTotalTravel() const { return _total_travel; }
+
+    /**
+     * @brief Get the number of slots the hands moved off the fault path.
+     */
+    size_t getAdvanceTravel() const { return _advance_travel; }
 
 protected:
-    virtual std::pair<pgidx_t, pgidx_t> _process(const pgidx_t& vpn, pf_t access_type) override
+    using typename Base::word_t;
+    using Base::WORD_BITS;
+    using Base::_hand;
+    using Base::_num_slots;
+    using Base::_used_slots;
+    using Base::_ref_bits;
+
+    size_t _spread;
+    size_t _advance_period;
+    size_t _until_advance;
+    size_t _max_travel = 0;
+    size_t _total_travel = 0;
+    size_t _advance_travel = 0;
+
+    // Every access counts toward the next advance
+    AccessStatus _accessRepeat(const pgidx_t& vpn, pf_t access_type)
     {
-        pgidx_t ppn = _memory->getFreePPage();
-        if (ppn != INVALID_PAGE) {
-            _alloc_pages.insert(vpn);
-            return { ppn, INVALID_PAGE };
-        }
-        auto c = _alloc_pages.current(), n = c;
-        for (int i = 0; i < 4; ++i) {
-            pf_t flag = (i & 0x1 ? PF_DIRTY : 0);
-            do {
-                auto pf = _memory->getVFlag(*n);
-                if ((pf & (PF_ACCESSED | PF_DIRTY)) == flag) {
-                    std::pair<pgidx_t, pgidx_t> ret = { _memory->getPPage(*n), *n };
-                    *n = vpn;
-                    _alloc_pages.next();
-                    return ret;
-                }
-                if (i == 1) {
-                    _memory->setVFlag(*n, pf & ~PF_ACCESSED);
-                }
-                n = _alloc_pages.next();
-            } while (n != c);
+        auto ret = Base::_accessRepeat(vpn, access_type);
+        if (ret != AccessStatus::Violation) {
+            _tick();
+        }
+        return ret;
+    }
+
+    size_t _selectVictim()
+    {
+        auto k = _findClear(_hand, _spread);
+        _clear(_hand + _spread, k + 1);
+        auto travel = k + 1;
+        _total_travel += travel;
+        _max_travel = std::max(_max_travel, travel);
+        return _wrap(_hand + k);
+    }
+
+    void _tick()
+    {
+        if (_advance_period == 0 || --_until_advance > 0) {
+            return;
+        }
+        _until_advance = _advance_period;
+        if (_used_slots < _num_slots) {
+            return; // Not full yet, faults take free frames
+        }
+        // The same steps as a fault, stopping right before the eviction
+        auto k = _findClear(_hand, _spread);
+        _clear(_hand + _spread, k);
+        _hand = _wrap(_hand + k);
+        _advance_travel += k;
+    }
+
+    static size_t _maxSpread(size_t num_slots) { return num_slots > 1 ? num_slots - 1 : 0; }
+
+    size_t _wrap(size_t slot) const { return slot >= _num_slots ? slot - _num_slots : slot; }
+
+    // Offset from the slot from of the first slot whose reference bit is clear, among the next count ones, or count
+    size_t _findClear(size_t from, size_t count) const
+    {
+        auto end = from + count;
+        if (end <= _num_slots) {
+            return _findClearIn(from, end) - from;
+        }
+        auto slot = _findClearIn(from, _num_slots);
+        if (slot < _num_slots) {
+            return slot - from;
+        }
+        return _num_slots - from + _findClearIn(0, end - _num_slots);
+    }
+
+    // Clear the reference bits of count slots from the slot from, which may be past the end of the ring
+    void _clear(size_t from, size_t count)
+    {
+        from = _wrap(from);
+        auto first = std::min(count, _num_slots - from);
+        _clearIn(from, from + first);
+        _clearIn(0, count - first);
+    }
+
+    size_t _findClearIn(size_t from, size_t to) const
+    {
+        for (size_t w = from / WORD_BITS; w * WORD_BITS < to; ++w) {
+            word_t cand = ~_ref_bits[w];
+            if (w == from / WORD_BITS) {
+                cand &= ~word_t(0) << (from % WORD_BITS);
+            }
+            if (cand) {
+                return std::min<size_t>(w * WORD_BITS + __builtin_ctzll(cand), to);
+            }
+        }
+        return to;
+    }
+
+    void _clearIn(size_t from, size_t to)
+    {
+        while (from < to) {
+            size_t bit = from % WORD_BITS;
+            size_t n = std::min(WORD_BITS - bit, to - from);
+            word_t mask = n == WORD_BITS ? ~word_t(0) : ((word_t(1) << n) - 1) << bit;
+            _ref_bits[from / WORD_BITS] &= ~mask;
+            from += n;
         }
-        return { INVALID_PAGE, INVALID_PAGE }; // Make compiler happy
     }
 };
 
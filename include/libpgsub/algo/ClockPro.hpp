@@ -0,0 +1,358 @@
+/**
+ * @file ClockPro.hpp
+ * @author your name (you@domain.com)
+ * @brief CLOCK-Pro algorithm implementation.
+ * @version 0.1
+ * @date 2024-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @details CLOCK-Pro (Jiang, Chen and Zhang) approximates LIRS with clock hands, so a hit only sets the reference bit.
+ * Resident pages are hot (LIR) or cold (HIR); a cold page gets a test period when it is loaded, and a page
+ * accessed again within its test period becomes hot. Evicted cold pages still in their test period are kept as
+ * non-resident entries, at most one per physical page. The target size of the cold pages grows by one when a cold
+ * page, resident or not, is accessed again within its test period, and shrinks by one when a test period ends without.
+ * All entries are in one circular list over VPN, swept by HAND_hot which demotes hot pages and ends the test periods
+ * it passes. HAND_cold and HAND_test only care for the resident cold pages and the non-resident ones, so each of these
+ * is also kept in a FIFO in the order the hands would meet them, and a fault never sweeps over the hot pages.
+ * The reference bit is PF_ACCESSED of the page table, set by writes too.
+ */
+
+#pragma once
+
+#include "../types.h"
+#include "../Exceptions.h"
+#include "Base.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+PGSUB_NAMESPACE_BEGIN
+
+template <typename Memory = AbstractMemory>
+class AlgoClockPro final : public AlgoBaseT<Memory> {
+private:
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_referenceWrite;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    enum State : uint8_t {
+        NONE,
+        HOT,
+        COLD, // Resident
+        GHOST, // Non-resident, in its test period
+    };
+
+    pgidx_t _num_vpages;
+    size_t _num_ppages;
+    size_t _max_ghosts;
+    size_t _cold_target = 1;
+    size_t _num_hot = 0;
+    size_t _num_cold = 0;
+    size_t _num_ghosts = 0;
+
+    // Circular list over VPN without sentinel, new entries go right behind HAND_hot
+    std::vector<pgidx_t> _prev;
+    std::vector<pgidx_t> _next;
+    pgidx_t _hand_hot = INVALID_PAGE;
+
+    // FIFOs of the resident cold pages (HAND_cold) and of the non-resident ones (HAND_test), sharing one pair of links.
+    // Slots _cold and _ghost are their sentinels: next is the oldest entry, prev the newest
+    pgidx_t _cold, _ghost;
+    std::vector<pgidx_t> _fifo_prev;
+    std::vector<pgidx_t> _fifo_next;
+
+    std::vector<State> _state; // VPN -> State
+    std::vector<bool> _test; // VPN -> In test period, for COLD
+
+public:
+    /**
+     * @brief Construct a new CLOCK-Pro object
+     *
+     * @param memory Pointer to Impl of AbstractMemory object
+     * @param num_vpages Number of pages of VIRTUAL memory
+     * @param max_ghosts Number of non-resident pages remembered, 0 for the number of physical pages.
+     */
+    AlgoClockPro(Memory* memory, const pgidx_t& num_vpages, size_t max_ghosts = 0)
+        : AlgoBaseT<Memory>(memory)
+        , _num_vpages(num_vpages)
+        , _num_ppages(memory->getNumPPages())
+        , _max_ghosts(max_ghosts ? max_ghosts : memory->getNumPPages())
+        , _prev(num_vpages, INVALID_PAGE)
+        , _next(num_vpages, INVALID_PAGE)
+        , _cold(num_vpages)
+        , _ghost(num_vpages + 1)
+        , _fifo_prev(num_vpages + 2)
+        , _fifo_next(num_vpages + 2)
+        , _state(num_vpages, NONE)
+        , _test(num_vpages, false)
+    {
+        for (auto nil : { _cold, _ghost }) {
+            _fifo_prev[nil] = _fifo_next[nil] = nil;
+        }
+    }
+
+    ~AlgoClockPro() = default;
+
+    AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) override
+    {
+        if (vpn >= _num_vpages) {
+            PGSUB_THROW(SimulateFaultInvalidVPN(std::to_string(vpn)));
+        }
+        auto ret = _memory->tryAccess(vpn, access_type);
+        if (ret == AccessStatus::Hit) {
+            _referenceWrite(vpn, access_type);
+        } else if (ret == AccessStatus::PageFault) {
+            _fault(vpn);
+            ret = _retry(vpn, access_type);
+            if (ret != AccessStatus::Violation) {
+                _clearRef(vpn); // Loading is not a reuse
+            }
+        }
+        return ret;
+    }
+
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(this, seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpage, access_type, count);
+    }
+
+    /**
+     * @brief Get the current target number of cold pages.
+     */
+    size_t getColdTarget() const { return _cold_target; }
+
+    /**
+     * @brief Get the number of resident hot pages.
+     */
+    size_t getNumHot() const { return _num_hot; }
+
+    /**
+     * @brief Get the number of non-resident pages remembered.
+     */
+    size_t getNumGhosts() const { return _num_ghosts; }
+
+private:
+    // The first repeat after a fault has to set the reference bit of a write
+    AccessStatus _accessRepeat(const pgidx_t& vpn, pf_t access_type)
+    {
+        return tryAccess(vpn, access_type);
+    }
+
+    void _fault(const pgidx_t& vpn)
+    {
+        // Out of the non-resident pages first, so that no hand ends the test period it was reused in
+        bool ghost = _state[vpn] == GHOST;
+        if (ghost) {
+            _remove(vpn);
+            _unlinkFifo(vpn);
+            _num_ghosts--;
+            _state[vpn] = NONE;
+        }
+        pgidx_t ppn = _memory->getFreePPage();
+        pgidx_t victim = INVALID_PAGE;
+        if (ppn == INVALID_PAGE) {
+            victim = _runHandCold();
+            ppn = _memory->getPPage(victim);
+            _num_evictions++;
+        }
+        _memory->load(vpn, ppn, victim);
+
+        if (ghost) {
+            // Reused within its test period, more cold pages would have kept it
+            _growCold();
+            _state[vpn] = HOT;
+            _num_hot++;
+            _insert(vpn);
+            _balanceHot();
+        } else if (_num_hot + _cold_target < _num_ppages) {
+            // Warming up, the first pages fill the hot part
+            _state[vpn] = HOT;
+            _num_hot++;
+            _insert(vpn);
+        } else {
+            _state[vpn] = COLD;
+            _test[vpn] = true;
+            _num_cold++;
+            _insert(vpn);
+            _pushFifo(_cold, vpn);
+        }
+    }
+
+    // Sweep HAND_cold to the first cold page not referenced, and evict it
+    pgidx_t _runHandCold()
+    {
+        while (true) {
+            auto x = _fifo_next[_cold];
+            if (x == _cold) {
+                PGSUB_THROW(std::runtime_error("[x] No page to evict"));
+            }
+            _unlinkFifo(x);
+            if (_clearRef(x)) {
+                _remove(x);
+                _insert(x);
+                if (_test[x]) {
+                    _growCold();
+                    _state[x] = HOT;
+                    _num_cold--;
+                    _num_hot++;
+                    _balanceHot();
+                } else {
+                    _test[x] = true;
+                    _pushFifo(_cold, x);
+                }
+                continue;
+            }
+            _num_cold--;
+            if (_test[x]) {
+                _state[x] = GHOST;
+                _pushFifo(_ghost, x);
+                if (++_num_ghosts > _max_ghosts) {
+                    _runHandTest();
+                }
+            } else {
+                _remove(x);
+                _state[x] = NONE;
+            }
+            return x;
+        }
+    }
+
+    // Sweep HAND_hot until one hot page not referenced is demoted, ending the test periods it passes
+    void _runHandHot()
+    {
+        while (true) {
+            auto x = _hand_hot;
+            _hand_hot = _next[x];
+            switch (_state[x]) {
+            case HOT:
+                if (!_clearRef(x)) {
+                    _state[x] = COLD;
+                    _test[x] = false;
+                    _num_hot--;
+                    _num_cold++;
+                    _pushFifo(_cold, x);
+                    return;
+                }
+                break;
+            case COLD:
+                if (_test[x]) {
+                    _test[x] = false;
+                    _shrinkCold();
+                }
+                break;
+            case GHOST:
+                _expire(x);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    // Advance HAND_test until the number of non-resident pages is within the bound
+    void _runHandTest()
+    {
+        while (_num_ghosts > _max_ghosts) {
+            auto x = _fifo_next[_ghost];
+            _expire(x);
+        }
+    }
+
+    void _balanceHot()
+    {
+        while (_num_hot > 0 && _num_hot + _cold_target > _num_ppages) {
+            _runHandHot();
+        }
+    }
+
+    // A non-resident page leaves its test period without a reuse
+    void _expire(const pgidx_t& vpn)
+    {
+        _remove(vpn);
+        _unlinkFifo(vpn);
+        _state[vpn] = NONE;
+        _num_ghosts--;
+        _shrinkCold();
+    }
+
+    // A cold page was reused within its test period, more cold pages would have kept it
+    void _growCold() { _cold_target = std::min(_cold_target + 1, _maxColdTarget()); }
+
+    // A test period ended without a reuse, fewer cold pages would have done
+    void _shrinkCold()
+    {
+        if (_cold_target > 1) {
+            _cold_target--;
+        }
+    }
+
+    size_t _maxColdTarget() const { return _num_ppages > 1 ? _num_ppages - 1 : 1; }
+
+    // Clear the reference bit, returning whether it was set
+    bool _clearRef(const pgidx_t& vpn)
+    {
+        auto flag = _memory->getVFlag(vpn);
+        if (flag & PF_ACCESSED) {
+            _memory->setVFlag(vpn, flag & ~PF_ACCESSED);
+            return true;
+        }
+        return false;
+    }
+
+    // Insert right behind HAND_hot, the last place any hand reaches
+    void _insert(const pgidx_t& vpn)
+    {
+        if (_hand_hot == INVALID_PAGE) {
+            _prev[vpn] = _next[vpn] = vpn;
+            _hand_hot = vpn;
+            return;
+        }
+        auto next = _hand_hot;
+        auto prev = _prev[next];
+        _prev[vpn] = prev;
+        _next[vpn] = next;
+        _next[prev] = vpn;
+        _prev[next] = vpn;
+    }
+
+    void _remove(const pgidx_t& vpn)
+    {
+        auto next = _next[vpn];
+        if (next == vpn) {
+            _hand_hot = INVALID_PAGE;
+            return;
+        }
+        if (_hand_hot == vpn) {
+            _hand_hot = next;
+        }
+        _next[_prev[vpn]] = next;
+        _prev[next] = _prev[vpn];
+    }
+
+    // Push to the newest end of the FIFO nil
+    void _pushFifo(const pgidx_t& nil, const pgidx_t& vpn)
+    {
+        _fifo_next[vpn] = nil;
+        _fifo_prev[vpn] = _fifo_prev[nil];
+        _fifo_next[_fifo_prev[nil]] = vpn;
+        _fifo_prev[nil] = vpn;
+    }
+
+    void _unlinkFifo(const pgidx_t& vpn)
+    {
+        _fifo_next[_fifo_prev[vpn]] = _fifo_next[vpn];
+        _fifo_prev[_fifo_next[vpn]] = _fifo_prev[vpn];
+    }
+};
+
+PGSUB_NAMESPACE_END
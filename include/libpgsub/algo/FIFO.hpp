@@ -6,7 +6,8 @@
  * @date 2024-10-16
  *
  * @copyright Copyright (c) 2024
- * @details
+ * @details The queue is a fixed-capacity ring buffer sized by the number of physical pages,
+ * so both insertion and eviction are O(1) without any allocation on the fault path.
  *
  */
 
@@ -17,49 +18,92 @@
 
 #include "Base.h"
 
-#include <deque>
+#include <vector>
 
 PGSUB_NAMESPACE_BEGIN
 
-class AlgoFIFO : public AlgoBase {
+template <typename Memory = AbstractMemory>
+class AlgoFIFO final : public AlgoBaseT<Memory> {
 private:
-    std::deque<pgidx_t> _pg_fifo;
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    std::vector<pgidx_t> _pg_fifo; // Ring buffer of VPN
+    size_t _head = 0;
+    size_t _size = 0;
+
+    size_t _num_free_loads = 0;
 
 public:
-    using AlgoBase::AlgoBase;
+    AlgoFIFO(Memory* memory)
+        : AlgoBaseT<Memory>(memory)
+        , _pg_fifo(memory->getNumPPages(), INVALID_PAGE)
+    {
+    }
 
     ~AlgoFIFO() = default;
 
-    void access(const pgidx_t& vpage, pf_t access_type) override
+    AccessStatus tryAccess(const pgidx_t& vpage, pf_t access_type) override
     {
-        try {
-            _memory->access(vpage, access_type);
-        } catch (PageFaultNotLoaded& e) {
+        auto ret = _memory->tryAccess(vpage, access_type);
+        if (ret == AccessStatus::PageFault) {
             auto vit = _findVictim();
             _memory->load(vpage, vit.first, vit.second);
-            // we had remapped the page, correct the FIFO
-            for (auto i = _pg_fifo.begin(); i < _pg_fifo.end(); i++) {
-                if (*i == vit.second) {
-                    _pg_fifo.erase(i);
-                    break;
-                }
-            }
-            _pg_fifo.push_back(vpage);
-            _memory->access(vpage, access_type); // access again
+            _push(vpage);
+            ret = _retry(vpage, access_type); // access again
         }
+        return ret;
+    }
+
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(this, seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpage, access_type, count);
     }
 
+    /**
+     * @brief Get the number of faults resolved with a free physical page.
+     */
+    size_t getNumFreeLoads() const { return _num_free_loads; }
+
 private:
     std::pair<pgidx_t, pgidx_t> _findVictim()
     {
         pgidx_t vit = _memory->getFreePPage();
         if (vit != INVALID_PAGE) {
+            _num_free_loads++;
             return { vit, INVALID_PAGE };
         }
-        auto v = _pg_fifo.front();
-        _pg_fifo.pop_front();
+        auto v = _pop();
+        _num_evictions++;
         return { _memory->getPPage(v), v };
     }
+
+    void _push(const pgidx_t& vpn)
+    {
+        auto tail = _head + _size;
+        if (tail >= _pg_fifo.size()) {
+            tail -= _pg_fifo.size();
+        }
+        _pg_fifo[tail] = vpn;
+        _size++;
+    }
+
+    pgidx_t _pop()
+    {
+        auto v = _pg_fifo[_head];
+        if (++_head == _pg_fifo.size()) {
+            _head = 0;
+        }
+        _size--;
+        return v;
+    }
 };
 
-PGSUB_NAMESPACE_END
\ No newline at end of file
+PGSUB_NAMESPACE_END
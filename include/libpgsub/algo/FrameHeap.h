@@ -0,0 +1,117 @@
+#pragma once
+
+#include "../types.h"
+
+#include <vector>
+
+PGSUB_NAMESPACE_BEGIN
+
+/**
+ * @brief Indexed max-heap over PPN, for algorithms evicting the frame with the largest key.
+ * @details Every frame knows its slot in the heap, so the key of a resident frame can be changed in O(log P).
+ */
+class FrameHeap {
+public:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    FrameHeap(size_t num_ppages)
+        : _pos(num_ppages, NPOS)
+        , _key(num_ppages, 0)
+    {
+        _heap.reserve(num_ppages);
+    }
+
+    bool contains(const pgidx_t& ppn) const { return _pos[ppn] != NPOS; }
+    bool empty() const { return _heap.empty(); }
+    size_t size() const { return _heap.size(); }
+
+    /**
+     * @brief The frame with the largest key.
+     */
+    pgidx_t top() const { return _heap.front(); }
+
+    size_t key(const pgidx_t& ppn) const { return _key[ppn]; }
+
+    /**
+     * @brief Insert a frame, or change its key if it is already in the heap.
+     */
+    void push(const pgidx_t& ppn, size_t key)
+    {
+        if (contains(ppn)) {
+            update(ppn, key);
+            return;
+        }
+        _pos[ppn] = _heap.size();
+        _heap.push_back(ppn);
+        _key[ppn] = key;
+        _siftUp(_pos[ppn]);
+    }
+
+    void update(const pgidx_t& ppn, size_t key)
+    {
+        auto prev = _key[ppn];
+        _key[ppn] = key;
+        if (key > prev) {
+            _siftUp(_pos[ppn]);
+        } else {
+            _siftDown(_pos[ppn]);
+        }
+    }
+
+    void erase(const pgidx_t& ppn)
+    {
+        auto i = _pos[ppn];
+        auto last = _heap.back();
+        _heap.pop_back();
+        _pos[ppn] = NPOS;
+        if (last != ppn) {
+            _heap[i] = last;
+            _pos[last] = i;
+            _siftUp(i);
+            _siftDown(_pos[last]);
+        }
+    }
+
+private:
+    std::vector<pgidx_t> _heap; // Heap slot -> PPN
+    std::vector<size_t> _pos; // PPN -> Heap slot
+    std::vector<size_t> _key; // PPN -> key
+
+    void _siftUp(size_t i)
+    {
+        auto ppn = _heap[i];
+        while (i > 0) {
+            auto parent = (i - 1) / 2;
+            if (_key[_heap[parent]] >= _key[ppn]) {
+                break;
+            }
+            _heap[i] = _heap[parent];
+            _pos[_heap[i]] = i;
+            i = parent;
+        }
+        _heap[i] = ppn;
+        _pos[ppn] = i;
+    }
+
+    void _siftDown(size_t i)
+    {
+        auto ppn = _heap[i];
+        auto n = _heap.size();
+        while (2 * i + 1 < n) {
+            auto child = 2 * i + 1;
+            if (child + 1 < n && _key[_heap[child + 1]] > _key[_heap[child]]) {
+                ++child;
+            }
+            if (_key[_heap[child]] <= _key[ppn]) {
+                break;
+            }
+            _heap[i] = _heap[child];
+            _pos[_heap[i]] = i;
+            i = child;
+        }
+        _heap[i] = ppn;
+        _pos[ppn] = i;
+    }
+};
+
+PGSUB_NAMESPACE_END
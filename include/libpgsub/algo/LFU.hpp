@@ -0,0 +1,246 @@
+/**
+ * @file LFU.hpp
+ * @author your name (you@domain.com)
+ * @brief A Least Frequently Used (LFU) algorithm implementation.
+ * @version 0.1
+ * @date 2024-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @details The constant time design of Shah, Mitra and Matani: a list of frequency buckets in increasing order,
+ * each holding the resident frames accessed that many times. An access moves the frame to the next bucket, which
+ * is created next to the current one if needed, and the victim comes from the first bucket, the least recently
+ * used frame of it on a tie. So every operation is O(1) without scanning the frames.
+ * With a decay period K, every count is halved every K accesses, so pages hot long ago age out. The halving maps
+ * the buckets in order, merging the ones which end up with the same count. A merge relabels the frames of the bucket
+ * merged away, so a decay is O(number of buckets + P) at worst, amortized over the K accesses of its period.
+ */
+
+#pragma once
+
+#include "../types.h"
+#include "../Exceptions.h"
+#include "Base.h"
+
+#include <algorithm>
+#include <vector>
+
+PGSUB_NAMESPACE_BEGIN
+
+template <typename Memory = AbstractMemory>
+class AlgoLFU final : public AlgoBaseT<Memory> {
+private:
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    static constexpr size_t NIL = 0; // Sentinel bucket, its next is the least frequent one
+
+    struct Bucket {
+        size_t count;
+        size_t prev, next; // Buckets in increasing count
+        pgidx_t head, tail; // Frames, the most recently used at head
+    };
+
+    size_t _decay_period;
+    size_t _until_decay;
+    size_t _num_decays = 0;
+
+    std::vector<Bucket> _buckets;
+    std::vector<size_t> _free_buckets;
+
+    // Frames of a bucket over PPN, INVALID_PAGE at the ends
+    std::vector<pgidx_t> _prev;
+    std::vector<pgidx_t> _next;
+    std::vector<size_t> _bucket; // PPN -> Bucket
+    std::vector<pgidx_t> _frame_vpn; // PPN -> VPN
+
+public:
+    /**
+     * @brief Construct a new LFU object
+     *
+     * @param memory Pointer to Impl of AbstractMemory object
+     * @param decay_period Number of accesses between two halvings of the counts, 0 to never decay.
+     */
+    AlgoLFU(Memory* memory, size_t decay_period = 0)
+        : AlgoBaseT<Memory>(memory)
+        , _decay_period(decay_period)
+        , _until_decay(decay_period)
+        , _prev(memory->getNumPPages(), INVALID_PAGE)
+        , _next(memory->getNumPPages(), INVALID_PAGE)
+        , _bucket(memory->getNumPPages(), NIL)
+        , _frame_vpn(memory->getNumPPages(), INVALID_PAGE)
+    {
+        // A bucket per distinct count of the frames, and one more while a frame moves
+        _buckets.resize(memory->getNumPPages() + 2);
+        _buckets[NIL] = { 0, NIL, NIL, INVALID_PAGE, INVALID_PAGE };
+        for (size_t b = _buckets.size() - 1; b > NIL; --b) {
+            _free_buckets.push_back(b);
+        }
+    }
+
+    ~AlgoLFU() = default;
+
+    AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) override
+    {
+        auto ret = _memory->tryAccess(vpn, access_type);
+        if (ret == AccessStatus::Hit) {
+            _touch(_memory->getPPage(vpn));
+        } else if (ret == AccessStatus::PageFault) {
+            auto ppage = _memory->getFreePPage();
+            pgidx_t lfu = INVALID_PAGE;
+            if (ppage == INVALID_PAGE) {
+                ppage = _buckets[_buckets[NIL].next].tail;
+                if (ppage == INVALID_PAGE) {
+                    PGSUB_THROW(std::runtime_error("[x] No page to evict"));
+                }
+                lfu = _frame_vpn[ppage];
+                _unlink(ppage);
+                _num_evictions++;
+            }
+            _memory->load(vpn, ppage, lfu);
+            _frame_vpn[ppage] = vpn;
+            _insert(ppage);
+            ret = _retry(vpn, access_type);
+        }
+        if (ret != AccessStatus::Violation && _decay_period && --_until_decay == 0) {
+            _decay();
+            _until_decay = _decay_period;
+        }
+        return ret;
+    }
+
+    // Every access of a run counts
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(this, seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpage, access_type, count);
+    }
+
+    /**
+     * @brief Get the number of times the counts were halved.
+     */
+    size_t getNumDecays() const { return _num_decays; }
+
+    /**
+     * @brief Get the number of distinct counts of the resident frames.
+     */
+    size_t getNumBuckets() const { return _buckets.size() - 1 - _free_buckets.size(); }
+
+private:
+    static constexpr bool _repeat_idempotent = false;
+
+    AccessStatus _accessRepeat(const pgidx_t& vpn, pf_t access_type)
+    {
+        return tryAccess(vpn, access_type);
+    }
+
+    // Move a frame to the bucket of the next count
+    void _touch(const pgidx_t& ppn)
+    {
+        auto b = _bucket[ppn];
+        auto n = _buckets[b].next;
+        if (n == NIL || _buckets[n].count != _buckets[b].count + 1) {
+            n = _newBucket(b, _buckets[b].count + 1);
+        }
+        _unlink(ppn);
+        _pushHead(n, ppn);
+    }
+
+    // A loaded frame has been accessed once
+    void _insert(const pgidx_t& ppn)
+    {
+        auto b = _buckets[NIL].next;
+        if (b == NIL || _buckets[b].count != 1) {
+            b = _newBucket(NIL, 1);
+        }
+        _pushHead(b, ppn);
+    }
+
+    // Halve every count, keeping the order of the buckets
+    void _decay()
+    {
+        size_t last = NIL;
+        for (auto b = _buckets[NIL].next; b != NIL;) {
+            auto next = _buckets[b].next;
+            auto count = std::max<size_t>(_buckets[b].count / 2, 1);
+            if (last != NIL && _buckets[last].count == count) {
+                // The frames of the larger count go on the recent side of the merged bucket
+                auto& from = _buckets[b];
+                auto& to = _buckets[last];
+                for (auto p = from.head; p != INVALID_PAGE; p = _next[p]) {
+                    _bucket[p] = last;
+                }
+                _next[from.tail] = to.head;
+                _prev[to.head] = from.tail;
+                to.head = from.head;
+                _removeBucket(b);
+            } else {
+                _buckets[b].count = count;
+                last = b;
+            }
+            b = next;
+        }
+        _num_decays++;
+    }
+
+    size_t _newBucket(size_t after, size_t count)
+    {
+        auto b = _free_buckets.back();
+        _free_buckets.pop_back();
+        auto next = _buckets[after].next;
+        _buckets[b] = { count, after, next, INVALID_PAGE, INVALID_PAGE };
+        _buckets[next].prev = b;
+        _buckets[after].next = b;
+        return b;
+    }
+
+    void _removeBucket(size_t b)
+    {
+        _buckets[_buckets[b].prev].next = _buckets[b].next;
+        _buckets[_buckets[b].next].prev = _buckets[b].prev;
+        _free_buckets.push_back(b);
+    }
+
+    void _pushHead(size_t b, const pgidx_t& ppn)
+    {
+        auto& bucket = _buckets[b];
+        _prev[ppn] = INVALID_PAGE;
+        _next[ppn] = bucket.head;
+        if (bucket.head != INVALID_PAGE) {
+            _prev[bucket.head] = ppn;
+        } else {
+            bucket.tail = ppn;
+        }
+        bucket.head = ppn;
+        _bucket[ppn] = b;
+    }
+
+    // Unlink a frame from its bucket, removing the bucket if it is left empty
+    void _unlink(const pgidx_t& ppn)
+    {
+        auto b = _bucket[ppn];
+        auto& bucket = _buckets[b];
+        if (_prev[ppn] != INVALID_PAGE) {
+            _next[_prev[ppn]] = _next[ppn];
+        } else {
+            bucket.head = _next[ppn];
+        }
+        if (_next[ppn] != INVALID_PAGE) {
+            _prev[_next[ppn]] = _prev[ppn];
+        } else {
+            bucket.tail = _prev[ppn];
+        }
+        _bucket[ppn] = NIL;
+        if (bucket.head == INVALID_PAGE) {
+            _removeBucket(b);
+        }
+    }
+};
+
+PGSUB_NAMESPACE_END
@@ -0,0 +1,284 @@
+/**
+ * @file LIRS.hpp
+ * @author your name (you@domain.com)
+ * @brief Low Inter-reference Recency Set (LIRS) algorithm implementation.
+ * @version 0.1
+ * @date 2024-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @details LIRS (Jiang and Zhang) ranks pages by their reuse distance instead of their recency. Most frames hold
+ * LIR pages, whose last reuse distance is small; a few frames (the HIR part) hold the other pages while they wait
+ * for a second access. A page loaded once by a scan only passes through the HIR frames, so loops larger than the
+ * memory do not flush the LIR set.
+ * The recency stack S and the queue Q of resident HIR pages are intrusive linked lists over VPN. The stack also keeps
+ * non-resident HIR pages; their number is bounded, the oldest one being forgotten first, so the metadata stays O(P).
+ */
+
+#pragma once
+
+#include "../types.h"
+#include "../Exceptions.h"
+#include "Base.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+PGSUB_NAMESPACE_BEGIN
+
+template <typename Memory = AbstractMemory>
+class AlgoLIRS final : public AlgoBaseT<Memory> {
+private:
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    enum State : uint8_t {
+        NONE,
+        LIR,
+        HIR_RESIDENT,
+        HIR_GHOST, // Non-resident, only kept in S
+    };
+
+    pgidx_t _num_vpages;
+    size_t _max_lir;
+    size_t _max_ghosts;
+    size_t _num_lir = 0;
+    size_t _num_ghosts = 0;
+
+    // Links over VPN. Slot _s is the sentinel of S (next is the top, prev the bottom);
+    // slots _q and _g are the sentinels of Q and of the ghosts (next is the newest, prev the oldest), which share one pair of links
+    pgidx_t _s, _q, _g;
+    std::vector<pgidx_t> _s_prev, _s_next;
+    std::vector<pgidx_t> _q_prev, _q_next;
+    std::vector<State> _state; // VPN -> State
+    std::vector<bool> _in_s; // VPN -> In S
+
+public:
+    /**
+     * @brief Construct a new LIRS object
+     *
+     * @param memory Pointer to Impl of AbstractMemory object
+     * @param num_vpages Number of pages of VIRTUAL memory
+     * @param hir_ratio Part of the physical pages holding HIR pages, at least one page and at most all but one.
+     * @param max_ghosts Number of non-resident HIR pages remembered, 0 for the number of physical pages.
+     */
+    AlgoLIRS(Memory* memory, const pgidx_t& num_vpages, double hir_ratio = 0.01, size_t max_ghosts = 0)
+        : AlgoBaseT<Memory>(memory)
+        , _num_vpages(num_vpages)
+        , _max_ghosts(max_ghosts ? max_ghosts : memory->getNumPPages())
+        , _s(num_vpages)
+        , _q(num_vpages + 1)
+        , _g(num_vpages + 2)
+        , _s_prev(num_vpages + 3)
+        , _s_next(num_vpages + 3)
+        , _q_prev(num_vpages + 3)
+        , _q_next(num_vpages + 3)
+        , _state(num_vpages, NONE)
+        , _in_s(num_vpages, false)
+    {
+        auto c = memory->getNumPPages();
+        auto hir = c > 1 ? std::clamp<size_t>(size_t(c * hir_ratio), 1, c - 1) : 0;
+        _max_lir = c - hir;
+        for (auto nil : { _s, _q, _g }) {
+            _s_prev[nil] = _s_next[nil] = _q_prev[nil] = _q_next[nil] = nil;
+        }
+    }
+
+    ~AlgoLIRS() = default;
+
+    AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) override
+    {
+        if (vpn >= _num_vpages) {
+            PGSUB_THROW(SimulateFaultInvalidVPN(std::to_string(vpn)));
+        }
+        auto ret = _memory->tryAccess(vpn, access_type);
+        if (ret == AccessStatus::Hit) {
+            _hit(vpn);
+        } else if (ret == AccessStatus::PageFault) {
+            _fault(vpn);
+            ret = _retry(vpn, access_type);
+        }
+        return ret;
+    }
+
+    // The first repeat may turn a HIR page into a LIR one, the next ones leave it on the top of S
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(this, seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpage, access_type, count);
+    }
+
+    /**
+     * @brief Get the number of resident LIR pages.
+     */
+    size_t getNumLIR() const { return _num_lir; }
+
+    /**
+     * @brief Get the number of non-resident HIR pages remembered.
+     */
+    size_t getNumGhosts() const { return _num_ghosts; }
+
+private:
+    // A repeated hit still has to move the page in S
+    AccessStatus _accessRepeat(const pgidx_t& vpn, pf_t access_type)
+    {
+        return tryAccess(vpn, access_type);
+    }
+
+    void _hit(const pgidx_t& vpn)
+    {
+        if (_state[vpn] == LIR) {
+            bool bottom = _s_prev[_s] == vpn;
+            _pushS(vpn);
+            if (bottom) {
+                _prune();
+            }
+        } else if (_in_s[vpn]) {
+            // Reused within the LIR set's recency, so its reuse distance beats the bottom LIR page
+            _unlinkQ(vpn);
+            _pushS(vpn);
+            _toLIR(vpn);
+            if (_num_lir > _max_lir) {
+                _demoteBottom();
+            }
+        } else {
+            _pushS(vpn);
+            _unlinkQ(vpn);
+            _pushQ(_q, vpn);
+        }
+    }
+
+    void _fault(const pgidx_t& vpn)
+    {
+        // Out of the ghosts first, so that the room made for the victim's ghost is never its own
+        bool ghost = _state[vpn] == HIR_GHOST;
+        if (ghost) {
+            _unlinkQ(vpn);
+            _num_ghosts--;
+            _state[vpn] = NONE;
+        }
+        pgidx_t ppn = _memory->getFreePPage();
+        pgidx_t victim = INVALID_PAGE;
+        if (ppn == INVALID_PAGE) {
+            if (_q_prev[_q] == _q && _num_lir > 0) {
+                // No resident HIR page, which happens with a single frame
+                _demoteBottom();
+            }
+            victim = _q_prev[_q];
+            if (victim == _q) {
+                PGSUB_THROW(std::runtime_error("[x] No page to evict"));
+            }
+            ppn = _memory->getPPage(victim);
+            _unlinkQ(victim);
+            if (_in_s[victim]) {
+                _state[victim] = HIR_GHOST;
+                _pushQ(_g, victim);
+                if (++_num_ghosts > _max_ghosts) {
+                    auto oldest = _q_prev[_g]; // Copied, unlinking it changes the slot
+                    _forget(oldest);
+                }
+            } else {
+                _state[victim] = NONE;
+            }
+            _num_evictions++;
+        }
+        _memory->load(vpn, ppn, victim);
+
+        if (ghost && _in_s[vpn]) {
+            // Reused within S, unless the single frame case pruned it meanwhile
+            _pushS(vpn);
+            _toLIR(vpn);
+            if (_num_lir > _max_lir) {
+                _demoteBottom();
+            }
+        } else if (_num_lir < _max_lir) {
+            // Warming up, the first pages fill the LIR set
+            _pushS(vpn);
+            _toLIR(vpn);
+        } else {
+            _pushS(vpn);
+            _state[vpn] = HIR_RESIDENT;
+            _pushQ(_q, vpn);
+        }
+    }
+
+    void _toLIR(const pgidx_t& vpn)
+    {
+        _state[vpn] = LIR;
+        _num_lir++;
+    }
+
+    // The LIR page at the bottom of S becomes a resident HIR page, then S is pruned
+    void _demoteBottom()
+    {
+        auto bottom = _s_prev[_s];
+        _unlinkS(bottom);
+        _state[bottom] = HIR_RESIDENT;
+        _num_lir--;
+        _pushQ(_q, bottom);
+        _prune();
+    }
+
+    // Pop HIR pages from the bottom of S until it is a LIR page
+    void _prune()
+    {
+        for (auto bottom = _s_prev[_s]; bottom != _s && _state[bottom] != LIR; bottom = _s_prev[_s]) {
+            if (_state[bottom] == HIR_GHOST) {
+                _forget(bottom);
+            } else {
+                _unlinkS(bottom);
+            }
+        }
+    }
+
+    void _forget(const pgidx_t& vpn)
+    {
+        _unlinkS(vpn);
+        _unlinkQ(vpn);
+        _state[vpn] = NONE;
+        _num_ghosts--;
+    }
+
+    void _pushS(const pgidx_t& vpn)
+    {
+        if (_in_s[vpn]) {
+            _unlinkS(vpn);
+        }
+        _s_prev[vpn] = _s;
+        _s_next[vpn] = _s_next[_s];
+        _s_prev[_s_next[_s]] = vpn;
+        _s_next[_s] = vpn;
+        _in_s[vpn] = true;
+    }
+
+    void _unlinkS(const pgidx_t& vpn)
+    {
+        _s_next[_s_prev[vpn]] = _s_next[vpn];
+        _s_prev[_s_next[vpn]] = _s_prev[vpn];
+        _in_s[vpn] = false;
+    }
+
+    void _pushQ(const pgidx_t& nil, const pgidx_t& vpn)
+    {
+        _q_prev[vpn] = nil;
+        _q_next[vpn] = _q_next[nil];
+        _q_prev[_q_next[nil]] = vpn;
+        _q_next[nil] = vpn;
+    }
+
+    void _unlinkQ(const pgidx_t& vpn)
+    {
+        _q_next[_q_prev[vpn]] = _q_next[vpn];
+        _q_prev[_q_next[vpn]] = _q_prev[vpn];
+    }
+};
+
+PGSUB_NAMESPACE_END
@@ -6,7 +6,9 @@
  * @date 2024-10-16
  * @details The LRU in hardware usually implemented by a counter and a auto-loading mechanism.
     * The counter is updated on every memory access. The counter is used to determine the least recently used page.
-    * Here we use a map to simulate the counter and hook the access function to update the counter.
+    * Here we keep an intrusive doubly linked list over the resident frames (indexed by PPN) and hook the access
+    * function to move the frame to the head, so both promotion and eviction are O(1) and the bookkeeping
+    * scales with the number of physical pages only.
     @note The implementation is not to be used in real OS or hardware.
  * @copyright Copyright (c) 2024
  *
@@ -18,54 +20,88 @@
 #include "../Exceptions.h"
 #include "Base.h"
 
-#include <algorithm>
-#include <map>
+#include <vector>
 
 PGSUB_NAMESPACE_BEGIN
 
-class AlgoLRU : public AlgoBase {
+template <typename Memory = AbstractMemory>
+class AlgoLRU final : public AlgoBaseT<Memory> {
 private:
-    std::map<pgidx_t, size_t> _vpc; // VPN -> counter
-    size_t _counter = 0;
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    // Recency list over PPN, slot _nil is the sentinel: _next[_nil] is the MRU frame, _prev[_nil] is the LRU one
+    pgidx_t _nil;
+    std::vector<pgidx_t> _prev;
+    std::vector<pgidx_t> _next;
+    std::vector<pgidx_t> _frame_vpn; // PPN -> VPN
 
 public:
-    using AlgoBase::AlgoBase;
+    AlgoLRU(Memory* memory)
+        : AlgoBaseT<Memory>(memory)
+        , _nil(memory->getNumPPages())
+        , _prev(_nil + 1, _nil)
+        , _next(_nil + 1, _nil)
+        , _frame_vpn(_nil, INVALID_PAGE)
+    {
+    }
 
     ~AlgoLRU() = default;
 
-    void access(const pgidx_t& vpn, pf_t access_type) override
+    AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) override
     {
-        _vpc[vpn] = _counter++;
-        try {
-            _memory->access(vpn, access_type);
-        } catch (PageFaultNotLoaded& e) {
+        auto ret = _memory->tryAccess(vpn, access_type);
+        if (ret == AccessStatus::Hit) {
+            auto ppage = _memory->getPPage(vpn);
+            _unlink(ppage);
+            _pushFront(ppage);
+        } else if (ret == AccessStatus::PageFault) {
             auto ppage = _memory->getFreePPage();
             pgidx_t lru = INVALID_PAGE;
             if (ppage == INVALID_PAGE) {
-                lru = _getLRU();
-                if (lru == INVALID_PAGE) {
-                    throw std::runtime_error("[x] No page to evict");
+                ppage = _prev[_nil];
+                if (ppage == _nil) {
+                    PGSUB_THROW(std::runtime_error("[x] No page to evict"));
                 }
-                ppage = _memory->getPPage(lru);
+                lru = _frame_vpn[ppage];
+                _unlink(ppage);
+                _num_evictions++;
             }
-            _vpc.erase(lru);
             _memory->load(vpn, ppage, lru);
-            _memory->access(vpn, access_type);
+            _frame_vpn[ppage] = vpn;
+            _pushFront(ppage);
+            ret = _retry(vpn, access_type);
         }
+        return ret;
+    }
+
+    // A repeated page is already the MRU one
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(this, seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpage, access_type, count);
     }
 
 private:
-    pgidx_t _getLRU() const
+    void _unlink(const pgidx_t& ppn)
     {
-        auto ret = std::min_element(_vpc.begin(), _vpc.end(),
-            [](const auto& a, const auto& b) {
-                return a.second < b.second;
-            });
-        if (ret == _vpc.end()) {
-            return INVALID_PAGE;
-        }
-        return ret->first;
+        _next[_prev[ppn]] = _next[ppn];
+        _prev[_next[ppn]] = _prev[ppn];
+    }
+
+    void _pushFront(const pgidx_t& ppn)
+    {
+        _prev[ppn] = _nil;
+        _next[ppn] = _next[_nil];
+        _prev[_next[_nil]] = ppn;
+        _next[_nil] = ppn;
     }
 };
 
-PGSUB_NAMESPACE_END
\ No newline at end of file
+PGSUB_NAMESPACE_END
@@ -0,0 +1,239 @@
+/**
+ * @file LRUK.hpp
+ * @author your name (you@domain.com)
+ * @brief LRU-K algorithm implementation.
+ * @version 0.1
+ * @date 2024-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @details LRU-K (O'Neil, O'Neil and Weikum) evicts the page whose K-th most recent reference is the oldest, the
+ * largest backward K-distance, so a page seen once by a scan goes before any page seen K times. Pages with less
+ * than K references have an infinite distance and go first, the one with the oldest last uncorrelated reference first.
+ * References within the correlated reference period of the last one are a burst and count as one: they only move
+ * the time of last use, and the history is shifted by the length of the burst when the next uncorrelated reference
+ * comes. A page used within the period is not evicted, unless every resident page was.
+ * The history of an evicted page is kept for a bounded number of pages, the oldest evicted one being forgotten first.
+ * Time is the number of accesses. Resident frames are in a FrameHeap keyed by their distance, so a fault is
+ * O(log P), only skipping the pages within the period, and a correlated hit is O(1).
+ */
+
+#pragma once
+
+#include "../types.h"
+#include "../Exceptions.h"
+#include "Base.h"
+#include "FrameHeap.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+PGSUB_NAMESPACE_BEGIN
+
+template <typename Memory = AbstractMemory>
+class AlgoLRUK final : public AlgoBaseT<Memory> {
+private:
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    static constexpr size_t HIGH = size_t(1) << (sizeof(size_t) * 8 - 1);
+
+    pgidx_t _num_vpages;
+    size_t _k;
+    size_t _crp;
+    size_t _max_history;
+    size_t _num_history = 0;
+    size_t _now = 0;
+
+    std::vector<size_t> _hist; // VPN * K + i -> Time of the i-th most recent uncorrelated reference from 0, 0 if none
+    std::vector<size_t> _last; // VPN -> Time of the last reference
+
+    // FIFO of the evicted pages with a history, over VPN. Slot _nil is the sentinel: next is the newest, prev the oldest
+    pgidx_t _nil;
+    std::vector<pgidx_t> _prev;
+    std::vector<pgidx_t> _next;
+    std::vector<bool> _in_history; // VPN -> Evicted with a history kept
+
+    FrameHeap _heap; // Resident frames, the victim on top
+    std::vector<pgidx_t> _frame_vpn; // PPN -> VPN
+    std::vector<pgidx_t> _skipped; // Frames taken off the heap by a fault while looking for the victim
+
+public:
+    /**
+     * @brief Construct a new LRU-K object
+     *
+     * @param memory Pointer to Impl of AbstractMemory object
+     * @param num_vpages Number of pages of VIRTUAL memory
+     * @param k Number of references kept per page, at least 1. LRU-1 is LRU.
+     * @param crp Correlated reference period, in accesses: a reference at most crp accesses after the last one is
+     * part of the same burst. 0 to count every reference.
+     * @param max_history Number of evicted pages whose history is kept, 0 for the number of physical pages.
+     */
+    AlgoLRUK(Memory* memory, const pgidx_t& num_vpages, size_t k = 2, size_t crp = 0, size_t max_history = 0)
+        : AlgoBaseT<Memory>(memory)
+        , _num_vpages(num_vpages)
+        , _k(k ? k : 1)
+        , _crp(crp)
+        , _max_history(max_history ? max_history : memory->getNumPPages())
+        , _hist(num_vpages * _k, 0)
+        , _last(num_vpages, 0)
+        , _nil(num_vpages)
+        , _prev(num_vpages + 1)
+        , _next(num_vpages + 1)
+        , _in_history(num_vpages, false)
+        , _heap(memory->getNumPPages())
+        , _frame_vpn(memory->getNumPPages(), INVALID_PAGE)
+    {
+        _prev[_nil] = _next[_nil] = _nil;
+    }
+
+    ~AlgoLRUK() = default;
+
+    AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) override
+    {
+        if (vpn >= _num_vpages) {
+            PGSUB_THROW(SimulateFaultInvalidVPN(std::to_string(vpn)));
+        }
+        auto ret = _memory->tryAccess(vpn, access_type);
+        if (ret == AccessStatus::Violation) {
+            return ret;
+        }
+        _now++;
+        if (ret == AccessStatus::Hit) {
+            _hit(vpn);
+        } else {
+            _fault(vpn);
+            ret = _retry(vpn, access_type);
+        }
+        return ret;
+    }
+
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(this, seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpage, access_type, count);
+    }
+
+    /**
+     * @brief Get the number of evicted pages whose history is kept.
+     */
+    size_t getNumHistory() const { return _num_history; }
+
+private:
+    static constexpr bool _repeat_idempotent = false;
+
+    // Every access advances the time
+    AccessStatus _accessRepeat(const pgidx_t& vpn, pf_t access_type)
+    {
+        return tryAccess(vpn, access_type);
+    }
+
+    void _hit(const pgidx_t& vpn)
+    {
+        if (_now - _last[vpn] > _crp) {
+            // A new burst, the previous one counts as a single reference at its start
+            auto hist = &_hist[vpn * _k];
+            auto burst = _last[vpn] - hist[0];
+            for (auto i = _k - 1; i > 0; --i) {
+                hist[i] = hist[i - 1] ? hist[i - 1] + burst : 0;
+            }
+            hist[0] = _now;
+            _heap.update(_memory->getPPage(vpn), _key(vpn));
+        }
+        _last[vpn] = _now;
+    }
+
+    void _fault(const pgidx_t& vpn)
+    {
+        // Out of the history first, so that the room made for the victim's history is never its own
+        bool known = _in_history[vpn];
+        if (known) {
+            _unlink(vpn);
+        }
+        pgidx_t ppn = _memory->getFreePPage();
+        pgidx_t victim = INVALID_PAGE;
+        if (ppn == INVALID_PAGE) {
+            if (_heap.empty()) {
+                PGSUB_THROW(std::runtime_error("[x] No page to evict"));
+            }
+            ppn = _selectVictim();
+            victim = _frame_vpn[ppn];
+            _heap.erase(ppn);
+            _remember(victim);
+            _num_evictions++;
+        }
+        _memory->load(vpn, ppn, victim);
+
+        auto hist = &_hist[vpn * _k];
+        if (known) {
+            for (auto i = _k - 1; i > 0; --i) {
+                hist[i] = hist[i - 1];
+            }
+        }
+        hist[0] = _now;
+        _last[vpn] = _now;
+        _frame_vpn[ppn] = vpn;
+        _heap.push(ppn, _key(vpn));
+    }
+
+    // The top of the heap, skipping the frames used within the correlated period, of which there are at most crp
+    pgidx_t _selectVictim()
+    {
+        pgidx_t ppn = INVALID_PAGE;
+        while (!_heap.empty()) {
+            auto top = _heap.top();
+            if (_now - _last[_frame_vpn[top]] > _crp) {
+                ppn = top;
+                break;
+            }
+            _skipped.push_back(top);
+            _heap.erase(top);
+        }
+        if (ppn == INVALID_PAGE) {
+            ppn = _skipped.front(); // Every page was used within the period, take the best one anyway
+        }
+        for (auto skipped : _skipped) {
+            _heap.push(skipped, _key(_frame_vpn[skipped]));
+        }
+        _skipped.clear();
+        return ppn;
+    }
+
+    // Larger for the better victim: first the pages with less than K references by their last uncorrelated one, then the others by their K-th last one
+    size_t _key(const pgidx_t& vpn) const
+    {
+        auto hist = &_hist[vpn * _k];
+        return hist[_k - 1] ? HIGH - 1 - hist[_k - 1] : HIGH | (HIGH - 1 - hist[0]);
+    }
+
+    void _remember(const pgidx_t& vpn)
+    {
+        _prev[vpn] = _nil;
+        _next[vpn] = _next[_nil];
+        _prev[_next[_nil]] = vpn;
+        _next[_nil] = vpn;
+        _in_history[vpn] = true;
+        if (++_num_history > _max_history) {
+            auto oldest = _prev[_nil]; // Copied, unlinking it changes the slot
+            _unlink(oldest);
+            std::fill(_hist.begin() + oldest * _k, _hist.begin() + (oldest + 1) * _k, 0);
+        }
+    }
+
+    void _unlink(const pgidx_t& vpn)
+    {
+        _next[_prev[vpn]] = _next[vpn];
+        _prev[_next[vpn]] = _prev[vpn];
+        _in_history[vpn] = false;
+        _num_history--;
+    }
+};
+
+PGSUB_NAMESPACE_END
@@ -9,6 +9,8 @@
  *
  * @details This file contains the OPT algorithm implementation.
     Note that OPT is not a practical algorithm, but it is useful for testing purposes.
+    The next use of every step is computed once in a backward pass on construction,
+    and resident frames are kept in a max-heap keyed by their next use, so a run costs O(N log P).
  */
 
 #ifndef __LIBPGSUB_ALGO_OPT_HPP__
@@ -16,63 +18,92 @@
 
 #include "../types.h"
 #include "Base.h"
+#include "FrameHeap.h"
 #include "../Exceptions.h"
 
 #include <string>
-#include <map>
+#include <limits>
 
 PGSUB_NAMESPACE_BEGIN
 
-class AlgoOPT : public AlgoBase {
+template <typename Memory = AbstractMemory>
+class AlgoOPT final : public AlgoBaseT<Memory> {
 private:
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    static constexpr size_t NEVER = std::numeric_limits<size_t>::max();
+
     pgidx_t _num_vpages;
-    std::vector<size_t> _next_access;
     AccessSeq_t _access_sequence;
+    std::vector<size_t> _next_use; // Step -> next step accessing the same VPN
     size_t _access_index = 0;
 
-    std::map<pgidx_t, pgidx_t>
-        _reverse_page_table; // PPN -> VPN (This is not to be used in real
-                             // hardware), and in test env, one PPN is mapped to
-                             // only one VPN
+    // Resident frames keyed by the next use of the VPN held by the frame
+    // Note that this is not to be used in real hardware
+    FrameHeap _heap;
+    std::vector<pgidx_t> _frame_vpn; // PPN -> VPN
 
 public:
-    AlgoOPT(AbstractMemory* memory, const pgidx_t& num_vpages, const AccessSeq_t& acc)
-        : AlgoBase(memory)
+    AlgoOPT(Memory* memory, const pgidx_t& num_vpages, const AccessSeq_t& acc)
+        : AlgoBaseT<Memory>(memory)
         , _num_vpages(num_vpages)
         , _access_sequence(acc)
+        , _heap(memory->getNumPPages())
+        , _frame_vpn(memory->getNumPPages(), INVALID_PAGE)
     {
-        _next_access.resize(num_vpages, -1);
+        _next_use.resize(acc.size(), NEVER);
+        std::vector<size_t> last(num_vpages, NEVER);
+        for (size_t i = acc.size(); i-- > 0;) {
+            auto vpn = acc[i].first;
+            if (vpn < num_vpages) {
+                _next_use[i] = last[vpn];
+                last[vpn] = i;
+            }
+        }
     }
 
     ~AlgoOPT() = default;
 
-    void access(const pgidx_t& vpage, pf_t access_type) override
+    AccessStatus tryAccess(const pgidx_t& vpage, pf_t access_type) override
     {
-        _process(vpage, access_type);
-        try {
-            _memory->access(vpage, access_type);
-        } catch (PageFaultNotLoaded& e) {
+        auto next = _process(vpage, access_type);
+        auto ret = _memory->tryAccess(vpage, access_type);
+        if (ret == AccessStatus::Hit) {
+            _heap.update(_memory->getPPage(vpage), next);
+        } else if (ret == AccessStatus::PageFault) {
             auto vit = _findVictim();
             _memory->load(vpage, vit.first, vit.second);
-            _reverse_page_table[vit.first] = vpage;
-            _memory->access(vpage, access_type); // check again
+            _frame_vpn[vit.first] = vpage;
+            _heap.push(vit.first, next);
+            ret = _retry(vpage, access_type); // check again
         }
-        // There could be other exceptions such as access violation which is
-        // throw by AbstractMemory.access(), delegate them to the caller
+        // There could be other faults such as access violation which is
+        // reported by AbstractMemory.tryAccess(), delegate them to the caller
+        return ret;
+    }
+
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(this, seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpage, access_type, count);
     }
 
 private:
-    // Get the virtual page number of a physical page
-    // Note that this is not to be used in real hardware
-    pgidx_t _getVPage(const pgidx_t& ppage)
+    // Every step moves the next use forward, so a repeat takes the full path
+    AccessStatus _accessRepeat(const pgidx_t& vpage, pf_t access_type)
     {
-        auto ret = _reverse_page_table.find(ppage);
-        if (ret == _reverse_page_table.end()) {
-            return INVALID_PAGE;
-        }
-        return ret->second;
+        return tryAccess(vpage, access_type);
     }
 
+    static constexpr bool _repeat_idempotent = false;
+
     // Find a physical page to be replaced
     std::pair<pgidx_t, pgidx_t> _findVictim()
     {
@@ -80,53 +111,28 @@ private:
         if (vit != INVALID_PAGE) {
             return { vit, INVALID_PAGE };
         }
-        size_t latest = 0;
-        pgidx_t evict_vpn = INVALID_PAGE;
-        for (auto i = 0; i < _memory->getNumPPages(); ++i) {
-            auto j = _getVPage(i);
-            if (_next_access[j] != -1) {
-                if (vit == INVALID_PAGE) {
-                    vit = i;
-                    latest = _next_access[j];
-                    evict_vpn = j;
-                } else {
-                    if (_next_access[j] > latest) {
-                        vit = i;
-                        latest = _next_access[j];
-                        evict_vpn = j;
-                    }
-                }
-            } else {
-                vit = i;
-                evict_vpn = j;
-                break;
-            }
-        }
-        return { vit, evict_vpn };
+        vit = _heap.top(); // The frame used farthest in the future
+        _num_evictions++;
+        return { vit, _frame_vpn[vit] };
     }
 
-    void _process(const pgidx_t& vpage, pf_t access_type)
+    // Check the step is in sync with the sequence, and return the next use of the VPN
+    size_t _process(const pgidx_t& vpage, pf_t access_type)
     {
         if(vpage >= _num_vpages) {
-            throw SimulateFaultInvalidVPN(std::to_string(vpage));
+            PGSUB_THROW(SimulateFaultInvalidVPN(std::to_string(vpage)));
         }
         if (_access_index >= _access_sequence.size()) {
-            throw SimulateFaultStepOutOfBound("# " + std::to_string(_access_index));
+            PGSUB_THROW(SimulateFaultStepOutOfBound("# " + std::to_string(_access_index)));
         }
         auto x = _access_sequence[_access_index];
         if (x.first != vpage || x.second != access_type) {
-            throw SimulateFaultStepNotSync(std::to_string(_access_index));
-        }
-        _access_index++;
-        _next_access.assign(_num_vpages, -1);
-        for (auto i = _access_index; i < _access_sequence.size(); ++i) {
-            if (i < _next_access[_access_sequence[i].first]) {
-                _next_access[_access_sequence[i].first] = i;
-            }
+            PGSUB_THROW(SimulateFaultStepNotSync(std::to_string(_access_index)));
         }
+        return _next_use[_access_index++];
     }
 };
 
 PGSUB_NAMESPACE_END
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,196 @@
+/**
+ * @file OPTWindow.hpp
+ * @author your name (you@domain.com)
+ * @brief OPT with a bounded lookahead.
+ * @version 0.1
+ * @date 2024-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @details AlgoOPT needs the whole sequence up front. This variant only sees a sliding window of the next
+ * accesses, and treats a page not used in the window as never used again, so it runs on traces of any length
+ * with O(W + V) memory. It gives the same faults as OPT when the window covers the rest of the trace.
+ * Accesses are fed with accessBatch() / accessRun(), which hold back the last W of them until the window
+ * behind them is full; flush() finishes them at the end of the trace.
+ */
+
+#pragma once
+
+#include "../types.h"
+#include "Base.h"
+#include "FrameHeap.h"
+#include "../Exceptions.h"
+
+#include <string>
+#include <limits>
+
+PGSUB_NAMESPACE_BEGIN
+
+template <typename Memory = AbstractMemory>
+class AlgoOPTWindow final : public AlgoBaseT<Memory> {
+private:
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    static constexpr size_t NEVER = std::numeric_limits<size_t>::max();
+
+    struct Pending {
+        pgidx_t vpn;
+        pf_t access_type;
+        size_t next; // Next step accessing the same VPN, if it is in the window
+    };
+
+    pgidx_t _num_vpages;
+    std::vector<Pending> _window; // Ring of the steps [_head, _tail)
+    size_t _head = 0;
+    size_t _tail = 0;
+    std::vector<size_t> _last; // VPN -> last step pushed
+
+    FrameHeap _heap; // Resident frames keyed by the next use in the window
+    std::vector<pgidx_t> _frame_vpn; // PPN -> VPN
+    std::vector<pgidx_t> _vpn_frame; // VPN -> PPN, if resident
+
+public:
+    /**
+     * @brief Construct a new OPT Window object
+     *
+     * @param memory Pointer to Impl of AbstractMemory object
+     * @param num_vpages Number of pages of VIRTUAL memory
+     * @param window Number of accesses looked ahead, including the one being accessed.
+     */
+    AlgoOPTWindow(Memory* memory, const pgidx_t& num_vpages, size_t window)
+        : AlgoBaseT<Memory>(memory)
+        , _num_vpages(num_vpages)
+        , _window(window ? window : 1)
+        , _last(num_vpages, NEVER)
+        , _heap(memory->getNumPPages())
+        , _frame_vpn(memory->getNumPPages(), INVALID_PAGE)
+        , _vpn_frame(num_vpages, INVALID_PAGE)
+    {
+    }
+
+    ~AlgoOPTWindow() = default;
+
+    /**
+     * @brief Access the oldest access in the window.
+     * @details vpage and access_type must match it, like AlgoOPT. With an empty window the access is taken first,
+     * which leaves nothing to look ahead; feed the window with lookahead() before stepping.
+     */
+    AccessStatus tryAccess(const pgidx_t& vpage, pf_t access_type) override
+    {
+        if (_head == _tail) {
+            _push(vpage, access_type);
+        }
+        auto& x = _window[_head % _window.size()];
+        if (x.vpn != vpage || x.access_type != access_type) {
+            PGSUB_THROW(SimulateFaultStepNotSync(std::to_string(_head)));
+        }
+        return _step();
+    }
+
+    size_t lookahead(AccessSpan_t seq) override
+    {
+        size_t n = 0;
+        for (; n < seq.size() && _tail - _head < _window.size(); ++n) {
+            _push(seq[n].first, seq[n].second);
+        }
+        return n;
+    }
+
+    /**
+     * @brief Push the accesses into the window, accessing the ones whose window is full.
+     * @return AccessStats Counts of the accesses done, which lag W behind the ones pushed.
+     */
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        AccessStats ret;
+        auto evictions = _num_evictions;
+        for (auto& acc : seq) {
+            if (_tail - _head == _window.size()) {
+                this->_count(ret, _step());
+            }
+            _push(acc.first, acc.second);
+        }
+        ret.evictions = _num_evictions - evictions;
+        return ret;
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        AccessStats ret;
+        auto evictions = _num_evictions;
+        for (size_t i = 0; i < count; ++i) {
+            if (_tail - _head == _window.size()) {
+                this->_count(ret, _step());
+            }
+            _push(vpage, access_type);
+        }
+        ret.evictions = _num_evictions - evictions;
+        return ret;
+    }
+
+    AccessStats flush() override
+    {
+        AccessStats ret;
+        auto evictions = _num_evictions;
+        while (_head != _tail) {
+            this->_count(ret, _step());
+        }
+        ret.evictions = _num_evictions - evictions;
+        return ret;
+    }
+
+private:
+    void _push(const pgidx_t& vpn, pf_t access_type)
+    {
+        if (vpn >= _num_vpages) {
+            PGSUB_THROW(SimulateFaultInvalidVPN(std::to_string(vpn)));
+        }
+        auto prev = _last[vpn];
+        if (prev != NEVER && prev >= _head) {
+            _window[prev % _window.size()].next = _tail;
+        } else if (_vpn_frame[vpn] != INVALID_PAGE) {
+            // The page had no use in the window, so its frame was a candidate to evict until now
+            _heap.update(_vpn_frame[vpn], _tail);
+        }
+        _window[_tail % _window.size()] = { vpn, access_type, NEVER };
+        _last[vpn] = _tail++;
+    }
+
+    // Access the oldest step of the window
+    AccessStatus _step()
+    {
+        auto x = _window[_head++ % _window.size()];
+        auto ret = _memory->tryAccess(x.vpn, x.access_type);
+        if (ret == AccessStatus::Hit) {
+            _heap.update(_memory->getPPage(x.vpn), x.next);
+        } else if (ret == AccessStatus::PageFault) {
+            auto vit = _findVictim();
+            _memory->load(x.vpn, vit.first, vit.second);
+            if (vit.second != INVALID_PAGE) {
+                _vpn_frame[vit.second] = INVALID_PAGE;
+            }
+            _frame_vpn[vit.first] = x.vpn;
+            _vpn_frame[x.vpn] = vit.first;
+            _heap.push(vit.first, x.next);
+            ret = _retry(x.vpn, x.access_type); // check again
+        }
+        return ret;
+    }
+
+    // Find a physical page to be replaced
+    std::pair<pgidx_t, pgidx_t> _findVictim()
+    {
+        pgidx_t vit = _memory->getFreePPage();
+        if (vit != INVALID_PAGE) {
+            return { vit, INVALID_PAGE };
+        }
+        vit = _heap.top(); // The frame used farthest in the window, or not at all
+        _num_evictions++;
+        return { vit, _frame_vpn[vit] };
+    }
+};
+
+PGSUB_NAMESPACE_END
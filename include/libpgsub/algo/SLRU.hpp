@@ -0,0 +1,174 @@
+/**
+ * @file SLRU.hpp
+ * @author your name (you@domain.com)
+ * @brief Segmented LRU (SLRU) algorithm implementation.
+ * @version 0.1
+ * @date 2024-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @details The frames are split into a probationary and a protected segment, both in LRU order. A page is loaded into
+ * the probationary segment and moves to the protected one when it is accessed again; the protected segment overflows
+ * into the probationary one, and victims come from the probationary segment. Pages accessed only once are evicted
+ * before any page accessed twice, so a scan does not flush the protected segment.
+ * Like AlgoLRU, the segments are intrusive doubly linked lists over PPN, so every operation is O(1).
+ */
+
+#pragma once
+
+#include "../types.h"
+#include "../Exceptions.h"
+#include "Base.h"
+
+#include <algorithm>
+#include <vector>
+
+PGSUB_NAMESPACE_BEGIN
+
+template <typename Memory = AbstractMemory>
+class AlgoSLRU final : public AlgoBaseT<Memory> {
+private:
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    enum Segment : uint8_t {
+        PROBATION,
+        PROTECTED,
+        NONE,
+    };
+
+    size_t _max_protected;
+    size_t _num_protected = 0;
+
+    // Lists over PPN, slot _nil + s is the sentinel of segment s: its next is the MRU frame, its prev the LRU one
+    pgidx_t _nil;
+    std::vector<pgidx_t> _prev;
+    std::vector<pgidx_t> _next;
+    std::vector<Segment> _segment; // PPN -> Segment
+    std::vector<pgidx_t> _frame_vpn; // PPN -> VPN
+
+public:
+    /**
+     * @brief Construct a new SLRU object
+     *
+     * @param memory Pointer to Impl of AbstractMemory object
+     * @param protected_ratio Size of the protected segment, as a fraction of the number of physical pages.
+     */
+    AlgoSLRU(Memory* memory, double protected_ratio = 0.8)
+        : AlgoBaseT<Memory>(memory)
+        , _max_protected(std::min<size_t>(size_t(memory->getNumPPages() * protected_ratio), memory->getNumPPages()))
+        , _nil(memory->getNumPPages())
+        , _prev(_nil + NONE)
+        , _next(_nil + NONE)
+        , _segment(_nil, NONE)
+        , _frame_vpn(_nil, INVALID_PAGE)
+    {
+        for (auto s : { PROBATION, PROTECTED }) {
+            _prev[_nil + s] = _next[_nil + s] = _nil + s;
+        }
+    }
+
+    ~AlgoSLRU() = default;
+
+    AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) override
+    {
+        auto ret = _memory->tryAccess(vpn, access_type);
+        if (ret == AccessStatus::Hit) {
+            auto ppage = _memory->getPPage(vpn);
+            if (_segment[ppage] == PROBATION) {
+                _promote(ppage);
+            } else {
+                _move(ppage, PROTECTED);
+            }
+        } else if (ret == AccessStatus::PageFault) {
+            auto ppage = _memory->getFreePPage();
+            pgidx_t lru = INVALID_PAGE;
+            if (ppage == INVALID_PAGE) {
+                ppage = _lru(PROBATION);
+                if (ppage == _nil + PROBATION) {
+                    ppage = _lru(PROTECTED);
+                }
+                if (ppage == _nil + PROTECTED) {
+                    PGSUB_THROW(std::runtime_error("[x] No page to evict"));
+                }
+                lru = _frame_vpn[ppage];
+                _unlink(ppage);
+                _num_evictions++;
+            }
+            _memory->load(vpn, ppage, lru);
+            _frame_vpn[ppage] = vpn;
+            _move(ppage, PROBATION);
+            ret = _retry(vpn, access_type);
+        }
+        return ret;
+    }
+
+    // The first repeat promotes the page, the next ones leave it as the MRU protected one
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(this, seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpage, access_type, count);
+    }
+
+    /**
+     * @brief Get the number of pages in the protected segment.
+     */
+    size_t getNumProtected() const { return _num_protected; }
+
+private:
+    // A repeated hit still has to promote a probationary page
+    AccessStatus _accessRepeat(const pgidx_t& vpn, pf_t access_type)
+    {
+        return tryAccess(vpn, access_type);
+    }
+
+    void _promote(const pgidx_t& ppn)
+    {
+        if (_max_protected == 0) {
+            _move(ppn, PROBATION);
+            return;
+        }
+        if (_num_protected == _max_protected) {
+            // The LRU protected frame gets another chance as the MRU probationary one
+            _move(_lru(PROTECTED), PROBATION);
+        }
+        _move(ppn, PROTECTED);
+    }
+
+    pgidx_t _lru(Segment s) const { return _prev[_nil + s]; }
+
+    void _unlink(const pgidx_t& ppn)
+    {
+        _next[_prev[ppn]] = _next[ppn];
+        _prev[_next[ppn]] = _prev[ppn];
+        if (_segment[ppn] == PROTECTED) {
+            _num_protected--;
+        }
+        _segment[ppn] = NONE;
+    }
+
+    // Unlink from the current segment, if any, and push as the MRU frame of s
+    void _move(const pgidx_t& ppn, Segment s)
+    {
+        if (_segment[ppn] != NONE) {
+            _unlink(ppn);
+        }
+        auto nil = _nil + s;
+        _prev[ppn] = nil;
+        _next[ppn] = _next[nil];
+        _prev[_next[nil]] = ppn;
+        _next[nil] = ppn;
+        _segment[ppn] = s;
+        if (s == PROTECTED) {
+            _num_protected++;
+        }
+    }
+};
+
+PGSUB_NAMESPACE_END
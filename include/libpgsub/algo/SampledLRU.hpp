@@ -0,0 +1,185 @@
+/**
+ * @file SampledLRU.hpp
+ * @author your name (you@domain.com)
+ * @brief Sampled approximate LRU algorithm implementation.
+ * @version 0.1
+ * @date 2024-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @details The eviction of Redis: no recency list, only a timestamp per frame, written on every hit. A fault samples
+ * a few random resident frames and evicts the least recently used of them. The good candidates of past faults are
+ * kept in a small pool sorted by timestamp, which the samples of each fault are merged into, and the victim is the
+ * oldest entry of the pool still valid, i.e. whose frame was not used since it entered the pool.
+ * A fault costs O(samples * pool size), whatever the number of physical pages; with more samples the order gets
+ * closer to LRU. The sampling is seeded, so runs are reproducible.
+ */
+
+#pragma once
+
+#include "../types.h"
+#include "../Exceptions.h"
+#include "Base.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+PGSUB_NAMESPACE_BEGIN
+
+template <typename Memory = AbstractMemory>
+class AlgoSampledLRU final : public AlgoBaseT<Memory> {
+private:
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    struct Candidate {
+        size_t slot;
+        size_t stamp; // Timestamp of the frame when it was sampled
+    };
+
+    size_t _num_samples;
+    size_t _pool_size;
+    size_t _now = 0;
+    size_t _num_slots = 0; // Frames loaded so far
+    size_t _num_pool_hits = 0;
+    std::mt19937_64 _rng;
+
+    std::vector<pgidx_t> _slot_vpn; // Slot -> VPN
+    std::vector<pgidx_t> _slot_ppn; // Slot -> PPN
+    std::vector<size_t> _ppn_slot; // PPN -> Slot
+    std::vector<size_t> _stamp; // Slot -> Time of the last access
+    std::vector<Candidate> _pool; // Oldest first
+
+public:
+    /**
+     * @brief Construct a new Sampled LRU object
+     *
+     * @param memory Pointer to Impl of AbstractMemory object
+     * @param num_samples Number of frames sampled on a fault, at least 1.
+     * @param pool_size Number of candidates kept across faults, 0 to evict the best of the samples only.
+     * @param seed Seed of the sampling.
+     */
+    AlgoSampledLRU(Memory* memory, size_t num_samples = 5, size_t pool_size = 16, uint64_t seed = 0)
+        : AlgoBaseT<Memory>(memory)
+        , _num_samples(num_samples ? num_samples : 1)
+        , _pool_size(pool_size)
+        , _rng(seed)
+        , _slot_vpn(memory->getNumPPages(), INVALID_PAGE)
+        , _slot_ppn(memory->getNumPPages(), INVALID_PAGE)
+        , _ppn_slot(memory->getNumPPages(), NPOS)
+        , _stamp(memory->getNumPPages(), 0)
+    {
+        _pool.reserve(_pool_size + 1);
+    }
+
+    ~AlgoSampledLRU() = default;
+
+    AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) override
+    {
+        auto ret = _memory->tryAccess(vpn, access_type);
+        if (ret == AccessStatus::Hit) {
+            _stamp[_ppn_slot[_memory->getPPage(vpn)]] = ++_now;
+        } else if (ret == AccessStatus::PageFault) {
+            _fault(vpn);
+            ret = _retry(vpn, access_type);
+        }
+        return ret;
+    }
+
+    // A repeated page is already the most recent one, the order of the timestamps does not change
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(this, seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpage, access_type, count);
+    }
+
+    /**
+     * @brief Get the number of victims taken from the pool, rather than from the samples of the fault.
+     */
+    size_t getNumPoolHits() const { return _num_pool_hits; }
+
+private:
+    void _fault(const pgidx_t& vpn)
+    {
+        size_t slot;
+        pgidx_t victim = INVALID_PAGE;
+        pgidx_t ppn = _memory->getFreePPage();
+        if (ppn != INVALID_PAGE) {
+            slot = _num_slots++;
+            _slot_ppn[slot] = ppn;
+            _ppn_slot[ppn] = slot;
+        } else {
+            if (_num_slots == 0) {
+                PGSUB_THROW(std::runtime_error("[x] No page to evict"));
+            }
+            slot = _selectVictim();
+            ppn = _slot_ppn[slot];
+            victim = _slot_vpn[slot];
+            _num_evictions++;
+        }
+        _memory->load(vpn, ppn, victim);
+        _slot_vpn[slot] = vpn;
+        _stamp[slot] = ++_now;
+    }
+
+    size_t _selectVictim()
+    {
+        size_t best = NPOS;
+        for (size_t i = 0; i < _num_samples; ++i) {
+            auto slot = size_t(_rng() % _num_slots);
+            if (best == NPOS || _stamp[slot] < _stamp[best]) {
+                best = slot;
+            }
+            _offer(slot);
+        }
+        // The oldest candidate not used since it was sampled, the stale ones are dropped on the way
+        size_t i = 0;
+        while (i < _pool.size() && _stamp[_pool[i].slot] != _pool[i].stamp) {
+            ++i;
+        }
+        if (i < _pool.size()) {
+            auto slot = _pool[i].slot;
+            _pool.erase(_pool.begin(), _pool.begin() + i + 1);
+            if (slot != best) {
+                _num_pool_hits++;
+            }
+            return slot;
+        }
+        _pool.clear();
+        return best;
+    }
+
+    // Insert a sampled frame into the pool, if it is older than its newest candidate or the pool is not full
+    void _offer(size_t slot)
+    {
+        if (_pool_size == 0) {
+            return;
+        }
+        auto stamp = _stamp[slot];
+        if (_pool.size() == _pool_size && stamp >= _pool.back().stamp) {
+            return;
+        }
+        size_t i = 0;
+        while (i < _pool.size() && _pool[i].stamp < stamp) {
+            ++i;
+        }
+        if (i < _pool.size() && _pool[i].slot == slot && _pool[i].stamp == stamp) {
+            return; // Sampled twice
+        }
+        _pool.insert(_pool.begin() + i, { slot, stamp });
+        if (_pool.size() > _pool_size) {
+            _pool.pop_back();
+        }
+    }
+};
+
+PGSUB_NAMESPACE_END
@@ -0,0 +1,218 @@
+/**
+ * @file WSClock.hpp
+ * @author your name (you@domain.com)
+ * @brief WSClock algorithm implementation.
+ * @version 0.1
+ * @date 2024-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * @details WSClock (Carr and Hennessy) evicts pages which have left the working set, the pages not used during the
+ * last tau accesses. Time is the virtual time of the process, the number of accesses made so far, kept by the
+ * algorithm since the memory has no clock. Like Clock, a hit only sets the reference bit, and the time of last use
+ * of a frame is only updated when the hand finds the bit set, so the hit path stays the one of the memory.
+ * On a fault the hand sweeps the frames in the order they were first loaded:
+ * - a referenced frame gets the current time and its bit cleared;
+ * - an old clean frame is the victim;
+ * - an old dirty frame is scheduled for write-back: PF_DIRTY is cleared as if the write was done, and the hand goes on.
+ * After a full turn, the first frame written back is taken, or else the least recently used clean frame, and only
+ * when every frame is dirty the least recently used one, whose eviction forces a write-back.
+ * The reference bit is PF_ACCESSED of the page table, set by writes too.
+ * The size of the working set is sampled every tau accesses, as the number of frames referenced or used within the window.
+ * A sample scans every frame, which costs O(P / tau) per access: cheap with the default tau of P, but with a tau of
+ * 1 every access is O(P).
+ */
+
+#pragma once
+
+#include "../types.h"
+#include "../Exceptions.h"
+#include "Base.h"
+
+#include <vector>
+
+PGSUB_NAMESPACE_BEGIN
+
+template <typename Memory = AbstractMemory>
+class AlgoWSClock final : public AlgoBaseT<Memory> {
+private:
+    using AlgoBaseT<Memory>::_memory;
+    using AlgoBaseT<Memory>::_retry;
+    using AlgoBaseT<Memory>::_referenceWrite;
+    using AlgoBaseT<Memory>::_num_evictions;
+    friend AlgoBaseT<Memory>;
+
+    size_t _tau;
+    size_t _now = 0; // Virtual time
+    size_t _until_sample;
+    size_t _hand = 0;
+    size_t _num_slots = 0; // Frames loaded so far, the ring of the hand
+
+    size_t _num_write_backs = 0;
+    size_t _num_dirty_evictions = 0;
+    std::vector<size_t> _ws_sizes;
+
+    std::vector<pgidx_t> _slot_vpn; // Slot -> VPN
+    std::vector<pgidx_t> _slot_ppn; // Slot -> PPN
+    std::vector<size_t> _last_use; // Slot -> Virtual time of last use
+
+public:
+    /**
+     * @brief Construct a new WSClock object
+     *
+     * @param memory Pointer to Impl of AbstractMemory object
+     * @param tau Working-set window, in accesses, 0 for the number of physical pages.
+     */
+    AlgoWSClock(Memory* memory, size_t tau = 0)
+        : AlgoBaseT<Memory>(memory)
+        , _tau(tau ? tau : memory->getNumPPages())
+        , _until_sample(_tau)
+        , _slot_vpn(memory->getNumPPages(), INVALID_PAGE)
+        , _slot_ppn(memory->getNumPPages(), INVALID_PAGE)
+        , _last_use(memory->getNumPPages(), 0)
+    {
+    }
+
+    ~AlgoWSClock() = default;
+
+    AccessStatus tryAccess(const pgidx_t& vpn, pf_t access_type) override
+    {
+        auto ret = _memory->tryAccess(vpn, access_type);
+        if (ret == AccessStatus::Violation) {
+            return ret;
+        }
+        _now++;
+        if (ret == AccessStatus::Hit) {
+            _referenceWrite(vpn, access_type);
+        } else {
+            _fault(vpn);
+            ret = _retry(vpn, access_type);
+            if (ret != AccessStatus::Violation) {
+                // The time of last use is exact, the bit would only be a second copy of it
+                _memory->setVFlag(vpn, _memory->getVFlag(vpn) & ~PF_ACCESSED);
+            }
+        }
+        if (--_until_sample == 0) {
+            _ws_sizes.push_back(_workingSetSize());
+            _until_sample = _tau;
+        }
+        return ret;
+    }
+
+    AccessStats accessBatch(AccessSpan_t seq) override
+    {
+        return this->_accessBatch(this, seq);
+    }
+
+    AccessStats accessRun(const pgidx_t& vpage, pf_t access_type, size_t count) override
+    {
+        return this->_accessRun(this, vpage, access_type, count);
+    }
+
+    /**
+     * @brief Get the working-set window, in accesses.
+     */
+    size_t getTau() const { return _tau; }
+
+    /**
+     * @brief Get the number of dirty pages written back by the hand before their eviction.
+     */
+    size_t getNumWriteBacks() const { return _num_write_backs; }
+
+    /**
+     * @brief Get the number of dirty pages evicted, each forcing a write-back on the fault path.
+     */
+    size_t getNumDirtyEvictions() const { return _num_dirty_evictions; }
+
+    /**
+     * @brief Get the size of the working set sampled every tau accesses.
+     */
+    const std::vector<size_t>& getWorkingSetSizes() const { return _ws_sizes; }
+
+private:
+    static constexpr bool _repeat_idempotent = false;
+
+    // Every access advances the virtual time
+    AccessStatus _accessRepeat(const pgidx_t& vpn, pf_t access_type)
+    {
+        return tryAccess(vpn, access_type);
+    }
+
+    void _fault(const pgidx_t& vpn)
+    {
+        size_t slot;
+        pgidx_t victim = INVALID_PAGE;
+        pgidx_t ppn = _memory->getFreePPage();
+        if (ppn != INVALID_PAGE) {
+            slot = _num_slots++;
+            _slot_ppn[slot] = ppn;
+        } else {
+            if (_num_slots == 0) {
+                PGSUB_THROW(std::runtime_error("[x] No page to evict"));
+            }
+            slot = _sweep();
+            ppn = _slot_ppn[slot];
+            victim = _slot_vpn[slot];
+            if (_memory->getVFlag(victim) & PF_DIRTY) {
+                _num_dirty_evictions++;
+            }
+            _num_evictions++;
+        }
+        _memory->load(vpn, ppn, victim);
+        _slot_vpn[slot] = vpn;
+        _last_use[slot] = _now;
+    }
+
+    // Run the hand for at most one turn, returning the slot to evict
+    size_t _sweep()
+    {
+        constexpr size_t NPOS = static_cast<size_t>(-1);
+        size_t written = NPOS;
+        size_t oldest = NPOS;
+        bool oldest_clean = false;
+        for (size_t i = 0; i < _num_slots; ++i) {
+            auto slot = _hand;
+            _hand = _next(_hand);
+            auto vpn = _slot_vpn[slot];
+            auto flag = _memory->getVFlag(vpn);
+            if (flag & PF_ACCESSED) {
+                _memory->setVFlag(vpn, flag & ~PF_ACCESSED);
+                _last_use[slot] = _now;
+            } else if (_now - _last_use[slot] > _tau) {
+                if ((flag & PF_DIRTY) == 0) {
+                    return slot;
+                }
+                _memory->setVFlag(vpn, flag & ~PF_DIRTY);
+                _num_write_backs++;
+                if (written == NPOS) {
+                    written = slot;
+                }
+                continue;
+            }
+            bool clean = (flag & PF_DIRTY) == 0;
+            if (oldest == NPOS || (clean && !oldest_clean) || (clean == oldest_clean && _last_use[slot] < _last_use[oldest])) {
+                oldest = slot;
+                oldest_clean = clean;
+            }
+        }
+        // The whole memory is the working set
+        auto slot = written != NPOS ? written : oldest;
+        _hand = _next(slot);
+        return slot;
+    }
+
+    size_t _next(size_t slot) const { return slot + 1 == _num_slots ? 0 : slot + 1; }
+
+    size_t _workingSetSize() const
+    {
+        size_t ret = 0;
+        for (size_t slot = 0; slot < _num_slots; ++slot) {
+            if ((_memory->getVFlag(_slot_vpn[slot]) & PF_ACCESSED) || _now - _last_use[slot] <= _tau) {
+                ret++;
+            }
+        }
+        return ret;
+    }
+};
+
+PGSUB_NAMESPACE_END
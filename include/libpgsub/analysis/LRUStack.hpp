@@ -0,0 +1,139 @@
+/**
+ * @file LRUStack.hpp
+ * @author your name (you@domain.com)
+ * @brief Single-pass LRU miss-ratio curve.
+ * @version 0.1
+ * @date 2024-10-16
+ *
+ * @copyright Copyright (c) 2024
+ * @details LRU has the stack property, so one pass computing the stack distance of every access
+ * (Mattson et al.) gives the fault count of every memory size at once.
+ * The stack distance is the number of distinct pages used since the last use of the page, counted
+ * with a Fenwick tree over the last-use times, so a trace of N accesses costs O(N log N).
+ *
+ */
+
+#pragma once
+
+#include "../types.h"
+
+#include <algorithm>
+#include <vector>
+
+PGSUB_NAMESPACE_BEGIN
+
+class LRUStackDistance {
+private:
+    static constexpr size_t NEVER = static_cast<size_t>(-1);
+
+    pgidx_t _num_vpages;
+    std::vector<size_t> _last_use; // VPN -> time of last use
+    std::vector<size_t> _tree; // Fenwick tree over time, 1 at the last use of every page
+    size_t _time = 0;
+
+    std::vector<size_t> _hist; // Stack distance -> count, distance 0 is never used before
+    size_t _num_accesses = 0;
+
+public:
+    /**
+     * @brief Construct a new LRU stack distance object
+     *
+     * @param num_vpages Number of pages of VIRTUAL memory
+     */
+    LRUStackDistance(const pgidx_t& num_vpages)
+        : _num_vpages(num_vpages)
+        , _last_use(num_vpages, NEVER)
+        , _tree(std::max<size_t>(4 * size_t(num_vpages), 1024) + 1, 0)
+        , _hist(size_t(num_vpages) + 1, 0)
+    {
+    }
+
+    ~LRUStackDistance() = default;
+
+    /**
+     * @brief Record an access to a page.
+     *
+     * @param vpn Virtual page accessed, must be less than num_vpages.
+     */
+    void access(const pgidx_t& vpn)
+    {
+        if (_time + 1 >= _tree.size()) {
+            _compact();
+        }
+        auto last = _last_use[vpn];
+        if (last == NEVER) {
+            _hist[0]++;
+        } else {
+            _hist[_sum(_time) - _sum(last)]++;
+            _add(last, -1);
+        }
+        _add(_time, 1);
+        _last_use[vpn] = _time++;
+        _num_accesses++;
+    }
+
+    void access(AccessSpan_t seq)
+    {
+        for (auto& acc : seq) {
+            access(acc.first);
+        }
+    }
+
+    /**
+     * @brief Get the fault count of LRU for every memory size.
+     *
+     * @return std::vector<size_t> Element i is the number of faults with i + 1 physical pages.
+     */
+    std::vector<size_t> getFaults() const
+    {
+        std::vector<size_t> ret(_num_vpages, 0);
+        size_t faults = _num_accesses;
+        for (size_t p = 1; p <= _num_vpages; ++p) {
+            faults -= _hist[p]; // Distance p hits with p frames or more
+            ret[p - 1] = faults;
+        }
+        return ret;
+    }
+
+    size_t getNumAccesses() const { return _num_accesses; }
+
+private:
+    // Number of pages with last use in [0, t)
+    size_t _sum(size_t t) const
+    {
+        size_t ret = 0;
+        for (; t > 0; t -= t & -t) {
+            ret += _tree[t];
+        }
+        return ret;
+    }
+
+    void _add(size_t t, size_t delta)
+    {
+        for (++t; t < _tree.size(); t += t & -t) {
+            _tree[t] += delta;
+        }
+    }
+
+    // Renumber the last uses to 0..k-1 keeping their order, once the time runs out of the tree
+    void _compact()
+    {
+        std::vector<pgidx_t> live;
+        for (pgidx_t i = 0; i < _num_vpages; ++i) {
+            if (_last_use[i] != NEVER) {
+                live.push_back(i);
+            }
+        }
+        std::sort(live.begin(), live.end(), [this](pgidx_t a, pgidx_t b) {
+            return _last_use[a] < _last_use[b];
+        });
+        std::fill(_tree.begin(), _tree.end(), 0);
+        _time = 0;
+        for (auto vpn : live) {
+            _add(_time, 1);
+            _last_use[vpn] = _time++;
+        }
+    }
+};
+
+PGSUB_NAMESPACE_END
@@ -8,4 +8,24 @@
 #else
 #define PGSUB_NAMESPACE_BEGIN
 #define PGSUB_NAMESPACE_END
-#endif
\ No newline at end of file
+#endif
+
+/**
+ * @brief Determines whether the library may throw.
+ * @details Default follows the compiler (e.g. off with -fno-exceptions). When disabled, the exception
+ * wrappers are not provided and simulation faults abort instead.
+ */
+#ifndef CONFIG_WITH_EXCEPTIONS
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+#define CONFIG_WITH_EXCEPTIONS 1
+#else
+#define CONFIG_WITH_EXCEPTIONS 0
+#endif
+#endif
+
+#if CONFIG_WITH_EXCEPTIONS
+#define PGSUB_THROW(e) throw e
+#else
+#include <cstdlib>
+#define PGSUB_THROW(e) std::abort()
+#endif
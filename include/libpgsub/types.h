@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 #include <utility>
@@ -38,6 +39,35 @@ constexpr pgidx_t INVALID_PAGE = -1;
 
 using AccessSeq_t = std::vector<std::pair<pgidx_t, pf_t>>;
 
+/**
+ * @brief Read-only view of contiguous accesses (std::span is not available in C++17)
+ */
+class AccessSpan_t {
+public:
+    using value_type = AccessSeq_t::value_type;
+
+    AccessSpan_t(const value_type* data, size_t size)
+        : _data(data)
+        , _size(size)
+    {
+    }
+
+    AccessSpan_t(const AccessSeq_t& seq)
+        : _data(seq.data())
+        , _size(seq.size())
+    {
+    }
+
+    const value_type* begin() const { return _data; }
+    const value_type* end() const { return _data + _size; }
+    const value_type& operator[](size_t i) const { return _data[i]; }
+    size_t size() const { return _size; }
+
+private:
+    const value_type* _data;
+    size_t _size;
+};
+
 #else
 #include CONFIG_WITH_CUSTOM_TYPES_HEADER
 #endif
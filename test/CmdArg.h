@@ -1,10 +1,17 @@
 #pragma once
 
+#include <algorithm>
 #include <getopt.h>
+#include <map>
+#include <random>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <iostream>
 
+#include "SimulateMemory.hpp"
+
 enum ProgramMode {
     MODE_NONE,
     MODE_SELFTEST,
@@ -15,7 +22,22 @@ enum ProgramMode {
     MODE_LRU,
     MODE_OPTCLOCK,
     MODE_CLOCK,
+    MODE_OPTWINDOW,
+    MODE_ARC,
+    MODE_LIRS,
+    MODE_CLOCKPRO,
+    MODE_2Q,
+    MODE_SLRU,
+    MODE_LFU,
+    MODE_WSCLOCK,
+    MODE_AGING,
+    MODE_CLOCK2,
+    MODE_LRUK,
+    MODE_SAMPLED,
 
+    MODE_MRC,
+    MODE_SWEEP,
+    MODE_CONVERT,
 };
 
 class CmdArgParser {
@@ -37,6 +59,22 @@ public:
             { "psize", optional_argument, 0, 'p' },
             { "vsize", optional_argument, 0, 'v' },
             { "numops", optional_argument, 0, 'n' },
+            { "jobs", required_argument, 0, 'j' },
+            { "verbose", required_argument, 0, 'V' },
+            { "convert", required_argument, 0, 'c' },
+            { "compress", no_argument, 0, 'z' },
+            { "stream", no_argument, 0, 'S' },
+            { "window", required_argument, 0, 'w' },
+            { "gen", required_argument, 0, 'g' },
+            { "seed", required_argument, 0, 's' },
+            { "2q", required_argument, 0, 'Q' },
+            { "slru", required_argument, 0, 'P' },
+            { "decay", required_argument, 0, 'd' },
+            { "tau", required_argument, 0, 't' },
+            { "aging", required_argument, 0, 'A' },
+            { "hands", required_argument, 0, 'H' },
+            { "lruk", required_argument, 0, 'K' },
+            { "sampled", required_argument, 0, 'R' },
             { 0, 0, 0, 0 }
         };
 
@@ -47,7 +85,7 @@ public:
             printHelp();
             exit(0);
         }
-        while ((c = getopt_long(argc, argv, "hi:o:a:p:v:n:", long_options, &option_index)) != -1) {
+        while ((c = getopt_long(argc, argv, "hi:o:a:p:v:n:j:V:c:zSw:g:s:Q:P:d:t:A:H:K:R:", long_options, &option_index)) != -1) {
             switch (c) {
             case 'i':
                 inputFile = optarg;
@@ -64,32 +102,10 @@ public:
                     std::cerr << "Multiple algorithm specified" << std::endl;
                     exit(-1);
                 }
-                if (std::string(optarg) == "all") {
-                    mode = MODE_ALL;
-                } else if (std::string(optarg) == "opt") {
-                    mode = MODE_OPT;
-                } else if (std::string(optarg) == "fifo") {
-                    mode = MODE_FIFO;
-                } else if (std::string(optarg) == "lru") {
-                    mode = MODE_LRU;
-                } else if (std::string(optarg) == "optclock") {
-                    mode = MODE_OPTCLOCK;
-                } else if (std::string(optarg) == "clock") {
-                    mode = MODE_CLOCK;
-                } else if (std::string(optarg) == "selftest") {
-                    mode = MODE_SELFTEST;
-                } else {
-                    std::cerr << "Unknown algorithm: " << optarg << std::endl;
-                    exit(-1);
-                }
+                parseAlgo(optarg);
                 break;
             case 'p':
-                try {
-                    psize = std::stoul(optarg);
-                } catch (std::exception& e) {
-                    std::cerr << "Invalid psize: " << optarg << std::endl;
-                    exit(-1);
-                }
+                parsePSize(optarg);
                 break;
             case 'v':
                 try {
@@ -107,6 +123,164 @@ public:
                     exit(-1);
                 }
                 break;
+            case 'j':
+                try {
+                    jobs = std::stoul(optarg);
+                } catch (std::exception& e) {
+                    std::cerr << "Invalid jobs: " << optarg << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 'V':
+                if (std::string(optarg) == "silent" || std::string(optarg) == "0") {
+                    verbosity = VERBOSE_SILENT;
+                } else if (std::string(optarg) == "fault" || std::string(optarg) == "1") {
+                    verbosity = VERBOSE_FAULT;
+                } else if (std::string(optarg) == "trace" || std::string(optarg) == "2") {
+                    verbosity = VERBOSE_TRACE;
+                } else {
+                    std::cerr << "Invalid verbosity: " << optarg << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 'c':
+                if (mode != MODE_NONE) {
+                    std::cerr << "Multiple algorithm specified" << std::endl;
+                    exit(-1);
+                }
+                mode = MODE_CONVERT;
+                convertFile = optarg;
+                break;
+            case 'z':
+                compress = true;
+                break;
+            case 'S':
+                stream = true;
+                break;
+            case 'g':
+                workload = optarg;
+                break;
+            case 's':
+                try {
+                    seed = std::stoull(optarg);
+                } catch (std::exception& e) {
+                    std::cerr << "Invalid seed: " << optarg << std::endl;
+                    exit(-1);
+                }
+                has_seed = true;
+                break;
+            case 'Q':
+                try {
+                    auto colon = std::string(optarg).find(':');
+                    kin = std::stod(std::string(optarg).substr(0, colon));
+                    if (colon != std::string::npos) {
+                        kout = std::stod(std::string(optarg).substr(colon + 1));
+                    }
+                } catch (std::exception& e) {
+                    kin = -1;
+                }
+                if (!(kin > 0 && kin < 1) || !(kout > 0)) {
+                    std::cerr << "Invalid 2q sizes: " << optarg << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 'P':
+                try {
+                    protected_ratio = std::stod(optarg);
+                } catch (std::exception& e) {
+                    protected_ratio = -1;
+                }
+                if (!(protected_ratio >= 0 && protected_ratio < 1)) {
+                    std::cerr << "Invalid slru size: " << optarg << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 'd':
+                try {
+                    decay = std::stoul(optarg);
+                } catch (std::exception& e) {
+                    std::cerr << "Invalid decay: " << optarg << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 't':
+                try {
+                    tau = std::stoul(optarg);
+                } catch (std::exception& e) {
+                    std::cerr << "Invalid tau: " << optarg << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 'A':
+                try {
+                    auto colon = std::string(optarg).find(':');
+                    age_bits = std::stoul(std::string(optarg).substr(0, colon));
+                    if (colon != std::string::npos) {
+                        tick = std::stoul(std::string(optarg).substr(colon + 1));
+                    }
+                } catch (std::exception& e) {
+                    age_bits = 0;
+                }
+                if (age_bits != 8 && age_bits != 16 && age_bits != 32) {
+                    std::cerr << "Invalid aging register: " << optarg << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 'H':
+                try {
+                    auto colon = std::string(optarg).find(':');
+                    spread = std::stoul(std::string(optarg).substr(0, colon));
+                    if (colon != std::string::npos) {
+                        advance = std::stoul(std::string(optarg).substr(colon + 1));
+                    }
+                } catch (std::exception& e) {
+                    std::cerr << "Invalid hands: " << optarg << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 'K':
+                try {
+                    std::stringstream ss(optarg);
+                    std::string part;
+                    std::getline(ss, part, ':');
+                    lruk_k = std::stoul(part);
+                    if (std::getline(ss, part, ':')) {
+                        crp = std::stoul(part);
+                    }
+                    if (std::getline(ss, part, ':')) {
+                        history = std::stoul(part);
+                    }
+                } catch (std::exception& e) {
+                    lruk_k = 0;
+                }
+                if (lruk_k == 0) {
+                    std::cerr << "Invalid lruk: " << optarg << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 'R':
+                try {
+                    auto colon = std::string(optarg).find(':');
+                    samples = std::stoul(std::string(optarg).substr(0, colon));
+                    if (colon != std::string::npos) {
+                        pool = std::stoul(std::string(optarg).substr(colon + 1));
+                    }
+                } catch (std::exception& e) {
+                    samples = 0;
+                }
+                if (samples == 0) {
+                    std::cerr << "Invalid sampled: " << optarg << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 'w':
+                try {
+                    window = std::stoul(optarg);
+                } catch (std::exception& e) {
+                    std::cerr << "Invalid window: " << optarg << std::endl;
+                    exit(-1);
+                }
+                break;
             default:
                 std::cerr << "Unknown option: " << (char)c << std::endl;
                 printHelp();
@@ -114,8 +288,26 @@ public:
                 break;
             }
         }
-        if (mode != MODE_SELFTEST) {
-            if (psize == 0 || vsize == 0) {
+        if (psizes.size() > 1 && mode != MODE_MRC && mode != MODE_SELFTEST) {
+            mode = MODE_SWEEP;
+        }
+        if (mode == MODE_SWEEP && algos.empty()) {
+            algos = allAlgos();
+        }
+        if (!has_seed) {
+            seed = (uint64_t(std::random_device()()) << 32) | std::random_device()();
+        }
+        if (jobs == 0) {
+            jobs = std::max(1u, std::thread::hardware_concurrency());
+        }
+        // A trace file brings its own vsize, which is checked after loading
+        if (mode == MODE_MRC || mode == MODE_CONVERT) {
+            if (vsize == 0 && inputFile.empty()) {
+                std::cerr << "Virtual memory size must be specified for " << (mode == MODE_MRC ? "miss-ratio curve" : "conversion") << std::endl;
+                exit(-1);
+            }
+        } else if (mode != MODE_SELFTEST) {
+            if (psizes.empty() || (vsize == 0 && inputFile.empty())) {
                 std::cerr << "Page size and virtual memory size must be specified during normal run" << std::endl;
                 exit(-1);
             }
@@ -129,22 +321,84 @@ public:
                   << "  -h, --help          Show this help message\n"
                   << "  -i, --input FILE    Input file\n"
                   << "  -o, --output FILE   Output file\n"
-                  << "  -a, --algo ALGO     Algorithm to use (all, opt, fifo, lru, optclock, clock; selftest)\n"
+                  << "  -a, --algo ALGO     Algorithm to use (all, opt, optw, fifo, lru, optclock, clock, arc, lirs, clockpro,\n"
+                  << "                      2q, slru, lfu, wsclock, aging, clock2,\n"
+                  << "                      lruk, sampled; mrc; selftest)\n"
+                  << "                      or a comma separated list of them to sweep\n"
                   << "  -p, --psize SIZE    Physical address space size (in pages)\n"
+                  << "                      or a comma separated list of SIZE, FIRST-LAST or FIRST-LAST:STEP to sweep\n"
                   << "  -v, --vsize SIZE    Virtual address space size (in pages)\n"
                   << "  -n, --numops NUM    Number of operations to simulate\n"
+                  << "  -j, --jobs NUM      Number of worker threads of sweep (default: number of cores)\n"
+                  << "  -V, --verbose LEVEL Output level (silent/0, fault/1, trace/2; default: trace)\n"
+                  << "  -c, --convert FILE  Convert the input to a binary trace file instead of running\n"
+                  << "  -z, --compress      Run-length and delta encode the converted trace\n"
+                  << "  -S, --stream        Simulate while reading the input, without keeping the whole trace\n"
+                  << "  -w, --window NUM    Number of accesses optw looks ahead (default: 65536)\n"
+                  << "  -g, --gen SPEC      Pattern of generated data (default: uniform)\n"
+                  << "  -s, --seed NUM      Seed of generated data and of the sampling of sampled (default: random)\n"
+                  << "  -Q, --2q KIN[:KOUT] Sizes of A1in and A1out of 2q, as fractions of psize (default: 0.25:0.5)\n"
+                  << "  -P, --slru FRAC     Size of the protected segment of slru, as a fraction of psize (default: 0.8)\n"
+                  << "  -d, --decay NUM     Number of accesses between two halvings of the counts of lfu (default: 0, never)\n"
+                  << "  -t, --tau NUM       Working-set window of wsclock, in accesses (default: psize); the working set\n"
+                  << "                      is sampled every NUM accesses with a scan of the frames, O(psize / NUM) per access\n"
+                  << "  -A, --aging BITS[:TICK] Width of the age registers of aging (8, 16 or 32) and accesses between\n"
+                  << "                      two ticks (default: 8:psize)\n"
+                  << "  -H, --hands SPREAD[:PERIOD] Slots between the hands of clock2 and accesses between two advances\n"
+                  << "                      of the hands off the fault path (default: psize/4:0, never)\n"
+                  << "  -K, --lruk K[:CRP[:HISTORY]] References kept per page by lruk, correlated reference period and\n"
+                  << "                      number of evicted pages remembered (default: 2:0:psize)\n"
+                  << "  -R, --sampled K[:POOL] Frames sampled on a fault by sampled and size of its eviction pool\n"
+                  << "                      (default: 5:16)\n"
                   << "\nNote 1) when running selftest, psize, vsize and numops are ignored\n"
                   << "     2) when running normal mode, psize and vsize must be specified\n"
                   << "     3) if numops is specified, random data will be generated to run\n"
                   << "        otherwise, test data will be read from stdin or input file\n"
-                  << "     4) custom input format: <vpn> <access_type> (space separated)\n";
+                  << "     4) custom input format: <vpn> <access_type> (space separated)\n"
+                  << "     5) mrc prints the LRU faults of every psize from 1 to vsize in one pass, psize is ignored\n"
+                  << "     6) sweep runs every (algorithm, psize) cell in parallel and prints only the summary table\n"
+                  << "     7) silent prints the statistics only, fault adds the faults and evictions,\n"
+                  << "        trace adds every access and the page table of every step\n"
+                  << "     8) a binary trace file given by -i is detected and mapped, vsize defaults to the one in the file;\n"
+                  << "        it is replayed from the mapping, and only decoded whole for opt, optw, convert, or a level\n"
+                  << "        above silent outside mrc and sweep\n"
+                  << "     9) stream runs every (algorithm, psize) cell on the same pass and prints only the summary table,\n"
+                  << "        opt needs the whole trace and is skipped\n"
+                  << "    10) optw is OPT looking only window accesses ahead, and reports its gap to opt when not streaming\n"
+                  << "    11) gen SPEC is a '+' separated mixture of NAME[:ARG[:ARG]][@WEIGHT] with NAME one of\n"
+                  << "        uniform, zipf[:S], scan, loop[:LEN], phase[:SIZE[:LEN]], e.g. zipf:1.2@0.8+scan@0.2;\n"
+                  << "        the same seed gives the same data\n";
     }
 
     std::string getInputFile() const { return inputFile; }
     std::string getOutputFile() const { return outputFile; }
+    std::string getConvertFile() const { return convertFile; }
+    bool getCompress() const { return compress; }
+    bool getStream() const { return stream; }
+    size_t getWindow() const { return window; }
+    std::string getWorkload() const { return workload; }
+    uint64_t getSeed() const { return seed; }
+    double getKin() const { return kin; }
+    double getKout() const { return kout; }
+    double getProtectedRatio() const { return protected_ratio; }
+    size_t getDecay() const { return decay; }
+    size_t getTau() const { return tau; }
+    size_t getAgeBits() const { return age_bits; }
+    size_t getTick() const { return tick; }
+    size_t getSpread() const { return spread; }
+    size_t getAdvance() const { return advance; }
+    size_t getLRUK() const { return lruk_k; }
+    size_t getCRP() const { return crp; }
+    size_t getHistory() const { return history; }
+    size_t getSamples() const { return samples; }
+    size_t getPool() const { return pool; }
 
     auto getMode() const { return mode; }
-    size_t getPSize() const { return psize; }
+    const auto& getAlgos() const { return algos; }
+    size_t getPSize() const { return psizes.empty() ? 0 : psizes.front(); }
+    const auto& getPSizes() const { return psizes; }
+    size_t getJobs() const { return jobs; }
+    Verbosity getVerbosity() const { return verbosity; }
     size_t getVSize() const { return vsize; }
     size_t getNumOps() const { return numops; }
 
@@ -153,8 +407,117 @@ private:
     char** argv;
     std::string inputFile;
     std::string outputFile;
+    std::string convertFile;
+    bool compress = false;
+    bool stream = false;
+    size_t window = 65536;
+    std::string workload = "uniform";
+    uint64_t seed = 0;
+    bool has_seed = false;
+    double kin = 0.25;
+    double kout = 0.5;
+    double protected_ratio = 0.8;
+    size_t decay = 0;
+    size_t tau = 0;
+    size_t age_bits = 8;
+    size_t tick = 0;
+    size_t spread = 0;
+    size_t advance = 0;
+    size_t lruk_k = 2;
+    size_t crp = 0;
+    size_t history = 0;
+    size_t samples = 5;
+    size_t pool = 16;
     ProgramMode mode = MODE_NONE;
-    size_t psize = 0;
+    std::vector<ProgramMode> algos;
+    std::vector<size_t> psizes;
     size_t vsize = 0;
     size_t numops = 0;
+    size_t jobs = 0;
+    Verbosity verbosity = VERBOSE_TRACE;
+
+    static const std::vector<ProgramMode>& allAlgos()
+    {
+        static const std::vector<ProgramMode> ret = { MODE_OPT, MODE_OPTWINDOW, MODE_FIFO, MODE_LRU, MODE_CLOCK, MODE_OPTCLOCK, MODE_ARC, MODE_LIRS, MODE_CLOCKPRO, MODE_2Q, MODE_SLRU, MODE_LFU, MODE_WSCLOCK, MODE_AGING, MODE_CLOCK2, MODE_LRUK, MODE_SAMPLED };
+        return ret;
+    }
+
+    void parseAlgo(const std::string& arg)
+    {
+        static const std::map<std::string, ProgramMode> names = {
+            { "opt", MODE_OPT },
+            { "optw", MODE_OPTWINDOW },
+            { "fifo", MODE_FIFO },
+            { "lru", MODE_LRU },
+            { "clock", MODE_CLOCK },
+            { "optclock", MODE_OPTCLOCK },
+            { "arc", MODE_ARC },
+            { "lirs", MODE_LIRS },
+            { "clockpro", MODE_CLOCKPRO },
+            { "2q", MODE_2Q },
+            { "slru", MODE_SLRU },
+            { "lfu", MODE_LFU },
+            { "wsclock", MODE_WSCLOCK },
+            { "aging", MODE_AGING },
+            { "clock2", MODE_CLOCK2 },
+            { "lruk", MODE_LRUK },
+            { "sampled", MODE_SAMPLED },
+        };
+        std::stringstream ss(arg);
+        std::string name;
+        while (std::getline(ss, name, ',')) {
+            auto it = names.find(name);
+            if (it != names.end()) {
+                mode = it->second;
+                algos.push_back(mode);
+            } else if (name == "all") {
+                mode = MODE_ALL;
+                algos.insert(algos.end(), allAlgos().begin(), allAlgos().end());
+            } else if (name == "mrc" && arg == name) {
+                mode = MODE_MRC;
+            } else if (name == "selftest" && arg == name) {
+                mode = MODE_SELFTEST;
+            } else {
+                std::cerr << "Unknown algorithm: " << name << std::endl;
+                exit(-1);
+            }
+        }
+        if (algos.size() > 1 && arg.find(',') != std::string::npos) {
+            mode = MODE_SWEEP;
+        }
+    }
+
+    void parsePSize(const std::string& arg)
+    {
+        std::stringstream ss(arg);
+        std::string item;
+        try {
+            while (std::getline(ss, item, ',')) {
+                auto dash = item.find('-');
+                if (dash == std::string::npos) {
+                    psizes.push_back(std::stoul(item));
+                    continue;
+                }
+                auto colon = item.find(':', dash);
+                size_t first = std::stoul(item.substr(0, dash));
+                size_t last = std::stoul(item.substr(dash + 1, colon - dash - 1));
+                size_t step = colon == std::string::npos ? 1 : std::stoul(item.substr(colon + 1));
+                if (step == 0 || first > last) {
+                    throw std::invalid_argument(item);
+                }
+                for (size_t p = first; p <= last; p += step) {
+                    psizes.push_back(p);
+                }
+            }
+        } catch (std::exception& e) {
+            std::cerr << "Invalid psize: " << arg << std::endl;
+            exit(-1);
+        }
+        for (auto p : psizes) {
+            if (p == 0) {
+                std::cerr << "Invalid psize: " << arg << std::endl;
+                exit(-1);
+            }
+        }
+    }
 };
\ No newline at end of file
@@ -0,0 +1,141 @@
+#ifndef FLAT_MEMORY_HPP
+#define FLAT_MEMORY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <libpgsub.h>
+
+using namespace LibPGSub;
+
+/**
+ * @brief Memory for benchmarking, with the same fault accounting as SimulateMemory but nothing printed.
+ * @details The page table is a dense array indexed by VPN, and free frames are kept on a stack,
+ * so every call on the access path is O(1). Frames are handed out from PPN 0 upwards like SimulateMemory,
+ * so algorithms make the same choices on both.
+ */
+class FlatMemory final : public LibPGSub::AbstractMemory {
+private:
+    struct PTE {
+        pf_t flags = 0;
+        pgidx_t ppn = INVALID_PAGE;
+    };
+
+    size_t _num_ppages;
+
+    size_t _pgfault_read_count = 0;
+    size_t _pgfault_write_count = 0;
+    size_t _pgfault_exec_count = 0;
+
+    std::vector<PTE> _page_table; // VPN -> PTE
+    std::vector<pgidx_t> _free_stack; // Free PPN, the lowest one on top
+    std::vector<bool> _palloc_table; // PPN -> isAllocated
+
+public:
+    /**
+     * @brief Construct a new Flat Memory object
+     *
+     * @param num_ppages Number of physical pages.
+     * @param num_vpages Number of virtual pages, accesses beyond are violations.
+     */
+    FlatMemory(size_t num_ppages, size_t num_vpages)
+        : _num_ppages(num_ppages)
+        , _page_table(num_vpages)
+    {
+        reset();
+    }
+    ~FlatMemory() = default;
+
+    AccessStatus tryAccess(const LibPGSub::pgidx_t& vpn,
+        LibPGSub::pf_t access_type) override
+    {
+        if (vpn >= _page_table.size()) {
+            return AccessStatus::Violation;
+        }
+        auto& pte = _page_table[vpn];
+        if ((pte.flags & PF_VALID) == 0) {
+            if (access_type & PF_WRITE) {
+                _pgfault_write_count++;
+            } else if (access_type & PF_READ) {
+                _pgfault_read_count++;
+            } else {
+                _pgfault_exec_count++;
+            }
+            return AccessStatus::PageFault;
+        }
+        pte.flags |= (access_type & PF_WRITE) ? PF_DIRTY : PF_ACCESSED;
+        return AccessStatus::Hit;
+    }
+
+    void load(const LibPGSub::pgidx_t& vpn,
+        const LibPGSub::pgidx_t& ppage, const pgidx_t& evict_vpn) override
+    {
+        if (ppage >= _num_ppages) {
+            throw LibPGSub::SimulateFaultInvalidPPN(std::to_string(ppage));
+        }
+        if (vpn >= _page_table.size()) {
+            throw LibPGSub::SimulateFaultInvalidVPN(std::to_string(vpn));
+        }
+        if (evict_vpn != INVALID_PAGE && evict_vpn < _page_table.size()) {
+            _page_table[evict_vpn].flags &= ~PF_VALID & ~PF_DIRTY & ~PF_ACCESSED;
+        }
+        _page_table[vpn] = { PF_VALID, ppage };
+        _palloc_table[ppage] = true;
+    }
+
+    size_t getNumPPages() const override { return _num_ppages; }
+
+    pgidx_t getFreePPage() override
+    {
+        // Frames reused by eviction stay on the stack until they reach the top
+        while (!_free_stack.empty() && _palloc_table[_free_stack.back()]) {
+            _free_stack.pop_back();
+        }
+        return _free_stack.empty() ? INVALID_PAGE : _free_stack.back();
+    }
+
+    pf_t getVFlag(const pgidx_t& vpn) const override
+    {
+        return vpn < _page_table.size() ? _page_table[vpn].flags : 0;
+    }
+
+    pf_t setVFlag(const pgidx_t& vpn, const pf_t& flag) override
+    {
+        if (vpn >= _page_table.size()) {
+            return 0; // No previous flag
+        }
+        auto old_flag = _page_table[vpn].flags;
+        _page_table[vpn].flags = flag;
+        return old_flag;
+    }
+
+    pgidx_t getPPage(const pgidx_t& vpn) override
+    {
+        return vpn < _page_table.size() ? _page_table[vpn].ppn : INVALID_PAGE;
+    }
+
+    void reset() override
+    {
+        std::fill(_page_table.begin(), _page_table.end(), PTE {});
+        _palloc_table.assign(_num_ppages, false);
+        _free_stack.resize(_num_ppages);
+        for (size_t i = 0; i < _num_ppages; ++i) {
+            _free_stack[i] = _num_ppages - 1 - i;
+        }
+        _pgfault_read_count = _pgfault_write_count = _pgfault_exec_count = 0;
+    }
+
+    // For testing purposes
+
+    size_t getNumPageFaultRead() const { return _pgfault_read_count; }
+    size_t getNumPageFaultWrite() const { return _pgfault_write_count; }
+    size_t getNumPageFaultExec() const { return _pgfault_exec_count; }
+    size_t getNumPageFault() const
+    {
+        return _pgfault_read_count + _pgfault_write_count + _pgfault_exec_count;
+    }
+};
+
+#endif // FLAT_MEMORY_HPP
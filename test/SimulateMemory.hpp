@@ -1,6 +1,7 @@
 #ifndef SIMULATE_MEMORY_HPP
 #define SIMULATE_MEMORY_HPP
 
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
 #include <map>
@@ -10,9 +11,19 @@
 
 using namespace LibPGSub;
 
-class SimulateMemory : public LibPGSub::AbstractMemory {
+/**
+ * @brief How much the simulation prints.
+ */
+enum Verbosity {
+    VERBOSE_SILENT, // Statistics only
+    VERBOSE_FAULT, // Faults and evictions
+    VERBOSE_TRACE, // Every access, with the page table of every step
+};
+
+class SimulateMemory final : public LibPGSub::AbstractMemory {
 private:
     size_t _num_ppages;
+    Verbosity _verbosity;
 
     size_t _pgfault_read_count = 0;
     size_t _pgfault_write_count = 0;
@@ -52,61 +63,76 @@ private:
     }
 
 public:
-    SimulateMemory(size_t num_ppages)
+    SimulateMemory(size_t num_ppages, Verbosity verbosity = VERBOSE_TRACE)
         : _num_ppages(num_ppages)
+        , _verbosity(verbosity)
     {
         _palloc_table.resize(num_ppages, false);
     }
     ~SimulateMemory() = default;
 
-    void access(const LibPGSub::pgidx_t& vpn,
+    AccessStatus tryAccess(const LibPGSub::pgidx_t& vpn,
         LibPGSub::pf_t access_type) override
     {
-        std::cout << "Accessing VPN # " << vpn << " with "
-                  << access_type_to_string(access_type) << std::endl;
         auto ret = _page_table.find(vpn);
-        if (ret == _page_table.end() || (ret->second.first & PF_VALID) == 0) {
+        bool fault = ret == _page_table.end() || (ret->second.first & PF_VALID) == 0;
+        if (_verbosity == VERBOSE_TRACE || (fault && _verbosity == VERBOSE_FAULT)) {
+            std::cout << "Accessing VPN # " << vpn << " with "
+                      << access_type_to_string(access_type) << "\n";
+        }
+        if (fault) {
             if (access_type & PF_WRITE) {
-                std::cout << "**Page Fault on Write**" << std::endl;
+                if (_verbosity != VERBOSE_SILENT) {
+                    std::cout << "**Page Fault on Write**\n";
+                }
                 _pgfault_write_count++;
-                throw LibPGSub::PageFaultWriteNotLoaded(std::to_string(vpn));
             } else if (access_type & PF_READ) {
-                std::cout << "**Page Fault on Read**" << std::endl;
+                if (_verbosity != VERBOSE_SILENT) {
+                    std::cout << "**Page Fault on Read**\n";
+                }
                 _pgfault_read_count++;
-                throw LibPGSub::PageFaultReadNotLoaded(std::to_string(vpn));
             } else {
-                std::cout << "**Page Fault on Exec**" << std::endl;
+                if (_verbosity != VERBOSE_SILENT) {
+                    std::cout << "**Page Fault on Exec**\n";
+                }
                 _pgfault_exec_count++;
-                throw LibPGSub::PageFaultExecNotLoaded(std::to_string(vpn));
             }
+            return AccessStatus::PageFault;
         }
 
         if (access_type & PF_WRITE) {
-            _page_table[vpn].first |= PF_DIRTY;
+            ret->second.first |= PF_DIRTY;
         } else {
-            _page_table[vpn].first |= PF_ACCESSED;
+            ret->second.first |= PF_ACCESSED;
         }
-        std::cout << "_Now the VPN has PPN # " << _page_table[vpn].second
-                  << " with flags " << pf_to_string(_page_table[vpn].first)
-                  << "_" << std::endl;
+        if (_verbosity == VERBOSE_TRACE) {
+            std::cout << "_Now the VPN has PPN # " << ret->second.second
+                      << " with flags " << pf_to_string(ret->second.first)
+                      << "_\n";
+        }
+        return AccessStatus::Hit;
     }
 
     void load(const LibPGSub::pgidx_t& vpn,
         const LibPGSub::pgidx_t& ppage, const pgidx_t& evict_vpn) override
     {
-        std::cout << "Loading VPN # " << vpn << " with PPN # " << ppage
-                  << std::endl;
+        if (_verbosity != VERBOSE_SILENT) {
+            std::cout << "Loading VPN # " << vpn << " with PPN # " << ppage
+                      << "\n";
+        }
         if (ppage > _num_ppages) {
             throw LibPGSub::SimulateFaultInvalidPPN(std::to_string(ppage));
         }
         if (evict_vpn != INVALID_PAGE && _page_table.find(evict_vpn) != _page_table.end()) {
             pf_t old_pf = _page_table[evict_vpn].first;
-            std::cout << "_PPN # " << _page_table[evict_vpn].second << " already loaded to VPN # " << evict_vpn
-                      << " and flags = " << pf_to_string(old_pf) << ", Evicting!_" << std::endl;
-            if (old_pf & PF_DIRTY) {
-                std::cout << "_Writing back dirty page to disk_" << std::endl;
-            } else {
-                std::cout << "_No need to write back_" << std::endl;
+            if (_verbosity != VERBOSE_SILENT) {
+                std::cout << "_PPN # " << _page_table[evict_vpn].second << " already loaded to VPN # " << evict_vpn
+                          << " and flags = " << pf_to_string(old_pf) << ", Evicting!_\n";
+                if (old_pf & PF_DIRTY) {
+                    std::cout << "_Writing back dirty page to disk_\n";
+                } else {
+                    std::cout << "_No need to write back_\n";
+                }
             }
             // _page_table.erase(evict_vpn);
             _page_table[evict_vpn].first &= ~PF_VALID & ~PF_DIRTY & ~PF_ACCESSED;
@@ -157,6 +183,7 @@ public:
 
     // For testing purposes
 
+    Verbosity getVerbosity() const { return _verbosity; }
     size_t getNumPageFaultRead() const { return _pgfault_read_count; }
     size_t getNumPageFaultWrite() const { return _pgfault_write_count; }
     size_t getNumPageFaultExec() const { return _pgfault_exec_count; }
@@ -173,7 +200,7 @@ public:
         for (auto& [vpn, pte] : _page_table) {
             str += "|" + std::to_string(vpn) + "\t|" + std::to_string(pte.second) + "\t|" + pf_to_string(pte.first) + "\t|\n";
         }
-        std::cout << str << std::endl;
+        std::cout << str << "\n";
     }
 
     const auto& getPageTable() const { return _page_table; }
@@ -4,6 +4,9 @@
 #include <libpgsub.h>
 #include <vector>
 #include <random>
+#include <string>
+
+#include "Workload.hpp"
 
 using namespace LibPGSub;
 
@@ -27,6 +30,7 @@ public:
         std::uniform_int_distribution<pgidx_t> dis_pg(0, _num_vpages - 1);
         std::uniform_int_distribution<short> dis_pf(0, 4);
 
+        _pgaccess_sequence.reserve(_pgaccess_sequence.size() + _num_ops);
 
         for (size_t i = 0; i < _num_ops; ++i) {
             _pgaccess_sequence.push_back(std::make_pair(dis_pg(gen), short2pf(dis_pf(gen))));
@@ -34,6 +38,16 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Generate a seeded synthetic workload, see Workload for the spec.
+     * @throw std::invalid_argument The spec is malformed.
+     */
+    SimulateProcess& workload(const std::string& spec, size_t num_ops, uint64_t seed, size_t jobs)
+    {
+        _pgaccess_sequence = Workload(spec, _num_vpages, seed).generate(num_ops, jobs);
+        return *this;
+    }
+
     const auto& operator()() const
     {
         return _pgaccess_sequence;
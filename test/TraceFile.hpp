@@ -0,0 +1,352 @@
+#ifndef TRACE_FILE_HPP
+#define TRACE_FILE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <libpgsub.h>
+
+using namespace LibPGSub;
+
+/**
+ * @brief Binary trace file, memory-mapped read-only.
+ * @details Layout (native byte order, which is checked by the magic):
+ *  - Header: magic "PGST", version, header size, page size, encoding, number of virtual pages and number of accesses
+ *  - Body of ENCODING_PACKED: one uint32_t per access, VPN << 3 | access type
+ *  - Body of ENCODING_RUN_DELTA: one varint per run of the same access, zigzag(VPN - previous VPN) << 4 | has count << 3 | access type,
+ *    followed by a varint of the length of the run if it is longer than 1
+ * A packed record is 4 bytes instead of the 8 bytes of AccessSeq_t::value_type, so VPNs are limited to 29 bits.
+ * Traces from the simulator repeat a page for long and move by small steps, so most runs take 1 or 2 bytes.
+ */
+class TraceFile {
+public:
+    static constexpr uint32_t MAGIC = 0x54534750; // "PGST" in little endian
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint32_t TYPE_BITS = 3;
+    static constexpr pgidx_t MAX_VPAGES = pgidx_t(1) << (32 - TYPE_BITS);
+    static constexpr uint32_t DEFAULT_PAGE_SIZE = 4096; // Same as sim/main.py
+
+    static constexpr uint32_t ENCODING_PACKED = 0;
+    static constexpr uint32_t ENCODING_RUN_DELTA = 1;
+
+    struct Header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t header_size;
+        uint32_t page_size;
+        uint32_t encoding;
+        uint64_t num_vpages;
+        uint64_t num_accesses;
+    };
+    static_assert(sizeof(Header) == 32, "Header must be packed");
+
+    using record_t = uint32_t;
+
+    /**
+     * @brief Accesses of the same page with the same type in a row.
+     */
+    struct Run {
+        pgidx_t vpn;
+        pf_t access_type;
+        size_t count;
+    };
+
+    TraceFile() = default;
+    TraceFile(const TraceFile&) = delete;
+    TraceFile& operator=(const TraceFile&) = delete;
+    ~TraceFile() { close(); }
+
+    /**
+     * @brief Map a trace file.
+     *
+     * @param path Path of the file.
+     * @return std::string Empty on success, otherwise the reason of failure.
+     */
+    std::string open(const std::string& path)
+    {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return "Cannot open " + path;
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0 || size_t(st.st_size) < sizeof(Header)) {
+            ::close(fd);
+            return "Not a trace file: " + path;
+        }
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return "Cannot map " + path;
+        }
+        _base = p;
+        _length = st.st_size;
+        madvise(_base, _length, MADV_SEQUENTIAL);
+
+        auto& h = header();
+        if (h.magic != MAGIC) {
+            close();
+            return "Not a trace file: " + path;
+        }
+        if (h.version != VERSION || h.header_size < sizeof(Header)) {
+            close();
+            return "Unsupported trace version: " + std::to_string(h.version);
+        }
+        if (h.encoding != ENCODING_PACKED && h.encoding != ENCODING_RUN_DELTA) {
+            close();
+            return "Unsupported trace encoding: " + std::to_string(h.encoding);
+        }
+        if (h.header_size > _length || (h.encoding == ENCODING_PACKED && h.header_size + h.num_accesses * sizeof(record_t) > _length)) {
+            close();
+            return "Truncated trace file: " + path;
+        }
+        _records = reinterpret_cast<const record_t*>(static_cast<const char*>(_base) + h.header_size);
+        return "";
+    }
+
+    void close()
+    {
+        if (_base) {
+            munmap(_base, _length);
+        }
+        _base = nullptr;
+        _records = nullptr;
+        _length = 0;
+    }
+
+    /**
+     * @brief Check whether a file starts with the magic of a trace file.
+     */
+    static bool isTraceFile(const std::string& path)
+    {
+        uint32_t magic = 0;
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) {
+            return false;
+        }
+        auto n = fread(&magic, sizeof(magic), 1, f);
+        fclose(f);
+        return n == 1 && magic == MAGIC;
+    }
+
+    const Header& header() const { return *static_cast<const Header*>(_base); }
+    size_t size() const { return header().num_accesses; }
+
+    /**
+     * @brief Raw records in the mapping, without any copy. Packed encoding only.
+     */
+    const record_t* records() const { return _records; }
+
+    static record_t encode(const pgidx_t& vpn, pf_t access_type)
+    {
+        return record_t(vpn) << TYPE_BITS | (access_type & ((1u << TYPE_BITS) - 1));
+    }
+
+    static AccessSeq_t::value_type decode(record_t rec)
+    {
+        return { pgidx_t(rec >> TYPE_BITS), pf_t(rec & ((1u << TYPE_BITS) - 1)) };
+    }
+
+    /**
+     * @brief Feed the runs of the trace to fn, in order, streaming over the mapping.
+     *
+     * @param fn Called with a Run.
+     * @return bool Whether the body decoded to exactly the number of accesses in the header.
+     */
+    template <typename Fn>
+    bool forEachRun(Fn fn) const
+    {
+        if (header().encoding == ENCODING_PACKED) {
+            for (size_t i = 0; i < size();) {
+                auto rec = _records[i];
+                size_t n = 1;
+                for (; i + n < size() && _records[i + n] == rec; ++n) { }
+                auto acc = decode(rec);
+                fn(Run { acc.first, acc.second, n });
+                i += n;
+            }
+            return true;
+        }
+        auto p = reinterpret_cast<const uint8_t*>(_records);
+        auto end = static_cast<const uint8_t*>(_base) + _length;
+        uint64_t vpn = 0;
+        size_t total = 0;
+        while (total < size()) {
+            uint64_t token, count = 1;
+            if (!_readVarint(p, end, token)) {
+                return false;
+            }
+            if ((token & 0x08) && !_readVarint(p, end, count)) {
+                return false;
+            }
+            uint64_t zz = token >> 4;
+            vpn += (zz >> 1) ^ -(zz & 1);
+            count = std::min<uint64_t>(count, size() - total);
+            fn(Run { pgidx_t(vpn), pf_t(token & 0x07), count });
+            total += count;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Feed the trace to fn in chunks, decoded into a buffer reused between chunks.
+     *
+     * @param fn Called with an AccessSpan_t of every chunk, in order.
+     * @param chunk Number of accesses per chunk.
+     * @return bool Whether the whole trace was decoded.
+     */
+    template <typename Fn>
+    bool forEachChunk(Fn fn, size_t chunk = 1 << 16) const
+    {
+        AccessSeq_t buf;
+        buf.reserve(chunk);
+        bool ok = forEachRun([&](const Run& run) {
+            for (size_t n = run.count; n > 0; --n) {
+                buf.push_back({ run.vpn, run.access_type });
+                if (buf.size() == chunk) {
+                    fn(AccessSpan_t(buf));
+                    buf.clear();
+                }
+            }
+        });
+        if (!buf.empty()) {
+            fn(AccessSpan_t(buf));
+        }
+        return ok;
+    }
+
+    /**
+     * @brief Replay the trace on an algorithm, one run per call.
+     */
+    AccessStats replay(AlgoBase* algo, bool* ok = nullptr) const
+    {
+        AccessStats ret;
+        auto add = [&](const AccessStats& st) {
+            ret.hits += st.hits;
+            ret.faults += st.faults;
+            ret.evictions += st.evictions;
+            ret.violations += st.violations;
+        };
+        bool done = forEachRun([&](const Run& run) {
+            add(algo->accessRun(run.vpn, run.access_type, run.count));
+        });
+        add(algo->flush());
+        if (ok) {
+            *ok = done;
+        }
+        return ret;
+    }
+
+    /**
+     * @brief Decode the whole trace.
+     * @return AccessSeq_t Shorter than size() if the body is truncated.
+     */
+    AccessSeq_t toSeq() const
+    {
+        AccessSeq_t ret;
+        ret.reserve(size());
+        forEachRun([&](const Run& run) {
+            ret.insert(ret.end(), run.count, { run.vpn, run.access_type });
+        });
+        return ret;
+    }
+
+    /**
+     * @brief Write a trace file.
+     *
+     * @return std::string Empty on success, otherwise the reason of failure.
+     */
+    static std::string write(const std::string& path, AccessSpan_t seq, size_t num_vpages,
+        uint32_t encoding = ENCODING_PACKED, uint32_t page_size = DEFAULT_PAGE_SIZE)
+    {
+        if (num_vpages >= MAX_VPAGES) {
+            return "Virtual memory too large for a trace file: " + std::to_string(num_vpages);
+        }
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f) {
+            return "Cannot open " + path;
+        }
+        Header h {};
+        h.magic = MAGIC;
+        h.version = VERSION;
+        h.header_size = sizeof(Header);
+        h.page_size = page_size;
+        h.encoding = encoding;
+        h.num_vpages = num_vpages;
+        h.num_accesses = seq.size();
+        bool ok = fwrite(&h, sizeof(h), 1, f) == 1;
+
+        std::vector<uint8_t> buf;
+        buf.reserve(1 << 18);
+        auto flush = [&]() {
+            ok = ok && fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+            buf.clear();
+        };
+        if (encoding == ENCODING_PACKED) {
+            for (auto& acc : seq) {
+                record_t rec = encode(acc.first, acc.second);
+                auto b = reinterpret_cast<const uint8_t*>(&rec);
+                buf.insert(buf.end(), b, b + sizeof(rec));
+                if (buf.size() + sizeof(rec) > buf.capacity()) {
+                    flush();
+                }
+            }
+        } else {
+            pgidx_t prev = 0;
+            for (size_t i = 0; i < seq.size();) {
+                size_t n = 1;
+                for (; i + n < seq.size() && seq[i + n] == seq[i]; ++n) { }
+                int64_t delta = int64_t(seq[i].first) - int64_t(prev);
+                uint64_t zz = (uint64_t(delta) << 1) ^ uint64_t(delta >> 63);
+                _writeVarint(buf, zz << 4 | (n > 1) << 3 | (seq[i].second & 0x07));
+                if (n > 1) {
+                    _writeVarint(buf, n);
+                }
+                prev = seq[i].first;
+                i += n;
+                if (buf.size() + 32 > buf.capacity()) {
+                    flush();
+                }
+            }
+        }
+        flush();
+        ok = fclose(f) == 0 && ok;
+        return ok ? "" : "Cannot write " + path;
+    }
+
+private:
+    void* _base = nullptr;
+    size_t _length = 0;
+    const record_t* _records = nullptr; // Start of the body
+
+    static bool _readVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v)
+    {
+        v = 0;
+        for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+            auto b = *p++;
+            v |= uint64_t(b & 0x7f) << shift;
+            if ((b & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void _writeVarint(std::vector<uint8_t>& buf, uint64_t v)
+    {
+        for (; v >= 0x80; v >>= 7) {
+            buf.push_back(uint8_t(v) | 0x80);
+        }
+        buf.push_back(uint8_t(v));
+    }
+};
+
+#endif // TRACE_FILE_HPP
@@ -0,0 +1,220 @@
+#ifndef TRACE_STREAM_HPP
+#define TRACE_STREAM_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <libpgsub.h>
+
+using namespace LibPGSub;
+
+/**
+ * @brief Bounded producer/consumer pipeline of access chunks.
+ * @details A producer thread parses the input into chunks while the caller simulates the previous ones.
+ * At most depth chunks exist at any time, so memory does not depend on the length of the trace.
+ */
+class ChunkPipeline {
+public:
+    /**
+     * @brief Producer side, appends accesses to the chunk being filled.
+     */
+    class Emit {
+    public:
+        void operator()(const pgidx_t& vpn, pf_t access_type)
+        {
+            if (!_buf) {
+                return;
+            }
+            _buf->push_back({ vpn, access_type });
+            if (_buf->size() == _pipe._chunk) {
+                _buf = _pipe._swap(_buf);
+            }
+        }
+
+        /**
+         * @brief Whether the consumer gave up, the producer should return.
+         */
+        bool stopped() const { return _buf == nullptr; }
+
+    private:
+        friend ChunkPipeline;
+
+        ChunkPipeline& _pipe;
+        AccessSeq_t* _buf;
+
+        Emit(ChunkPipeline& pipe, AccessSeq_t* buf)
+            : _pipe(pipe)
+            , _buf(buf)
+        {
+        }
+    };
+
+    /**
+     * @brief Construct a new Chunk Pipeline object
+     *
+     * @param chunk Number of accesses per chunk.
+     * @param depth Number of chunks in flight, including the one being filled and the one being simulated.
+     */
+    ChunkPipeline(size_t chunk = 1 << 16, size_t depth = 4)
+        : _chunk(chunk)
+        , _bufs(std::max<size_t>(depth, 2))
+    {
+        for (auto& buf : _bufs) {
+            buf.reserve(chunk);
+            _free.push(&buf);
+        }
+    }
+
+    /**
+     * @brief Run the pipeline until the producer is done.
+     *
+     * @param produce Called on a worker thread with an Emit&, returns an error message or an empty string.
+     * @param consume Called on this thread with an AccessSpan_t of every chunk, in order. Returns false to stop early.
+     * @return std::string Error of the producer, if any.
+     */
+    template <typename Produce, typename Consume>
+    std::string run(Produce produce, Consume consume)
+    {
+        std::string error;
+        std::thread producer([&]() {
+            Emit emit(*this, _takeFree());
+            if (!emit.stopped()) {
+                error = produce(emit);
+            }
+            if (!emit.stopped()) {
+                _push(emit._buf);
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            _done = true;
+            _cv.notify_all();
+        });
+        while (auto buf = _takeFull()) {
+            bool go_on = consume(AccessSpan_t(*buf));
+            buf->clear();
+            std::lock_guard<std::mutex> lock(_mutex);
+            _free.push(buf);
+            if (!go_on) {
+                _stop = true;
+            }
+            _cv.notify_all();
+        }
+        producer.join();
+        return error;
+    }
+
+private:
+    size_t _chunk;
+    std::vector<AccessSeq_t> _bufs;
+    std::queue<AccessSeq_t*> _full;
+    std::queue<AccessSeq_t*> _free;
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _done = false;
+    bool _stop = false;
+
+    AccessSeq_t* _takeFree()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return _stop || !_free.empty(); });
+        if (_stop) {
+            return nullptr;
+        }
+        auto buf = _free.front();
+        _free.pop();
+        return buf;
+    }
+
+    void _push(AccessSeq_t* buf)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!buf->empty()) {
+            _full.push(buf);
+        } else {
+            _free.push(buf);
+        }
+        _cv.notify_all();
+    }
+
+    AccessSeq_t* _swap(AccessSeq_t* buf)
+    {
+        _push(buf);
+        return _takeFree();
+    }
+
+    AccessSeq_t* _takeFull()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return _stop || _done || !_full.empty(); });
+        if (_stop || _full.empty()) {
+            return nullptr;
+        }
+        auto buf = _full.front();
+        _full.pop();
+        return buf;
+    }
+};
+
+/**
+ * @brief Parse a text trace of "<vpn> <access_type>" pairs from f.
+ * @details Reads blocks with fread and parses the digits by hand, which is much cheaper than std::cin >>.
+ *
+ * @param vsize VPNs larger than this are rejected.
+ * @return std::string Error message, or an empty string.
+ */
+inline std::string readTextTrace(FILE* f, size_t vsize, ChunkPipeline::Emit& emit)
+{
+    std::vector<char> buf(1 << 20);
+    uint64_t num[2] = { 0, 0 };
+    int k = 0;
+    bool in_num = false;
+    auto finish = [&]() -> std::string {
+        in_num = false;
+        if (++k < 2) {
+            return "";
+        }
+        k = 0;
+        if (num[0] > vsize) {
+            return "Invalid VPN: " + std::to_string(num[0]);
+        }
+        if (num[1] > 7) {
+            return "Invalid Access Type: " + std::to_string(num[1]);
+        }
+        emit(pgidx_t(num[0]), pf_t(num[1]));
+        return "";
+    };
+    size_t n;
+    while (!emit.stopped() && (n = fread(buf.data(), 1, buf.size(), f)) > 0) {
+        for (size_t i = 0; i < n; ++i) {
+            char c = buf[i];
+            if (c >= '0' && c <= '9') {
+                if (!in_num) {
+                    in_num = true;
+                    num[k] = 0;
+                }
+                if (num[k] <= vsize) { // Saturate, it is rejected anyway
+                    num[k] = num[k] * 10 + (c - '0');
+                }
+            } else if (c == ' ' || c == '\n' || c == '\t' || c == '\r') {
+                if (in_num) {
+                    auto err = finish();
+                    if (!err.empty()) {
+                        return err;
+                    }
+                }
+            } else {
+                return std::string("Invalid character in input: ") + c;
+            }
+        }
+    }
+    return in_num ? finish() : "";
+}
+
+#endif // TRACE_STREAM_HPP
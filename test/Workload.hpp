@@ -0,0 +1,310 @@
+#ifndef WORKLOAD_HPP
+#define WORKLOAD_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <libpgsub.h>
+
+using namespace LibPGSub;
+
+/**
+ * @brief Seeded synthetic workload, a weighted mixture of access patterns.
+ * @details The trace is generated in blocks of BLOCK accesses, each from its own generator seeded by (seed, block),
+ * and the patterns depend only on the position in the trace. So any block can be generated on its own,
+ * and the trace is the same for the same seed whatever the number of threads.
+ *
+ * Spec: components joined by '+', each NAME[:ARG[:ARG]][@WEIGHT]
+ *  - uniform            every page with the same probability
+ *  - zipf[:S]           Zipfian popularity with exponent S (default 1.0), the hot pages scattered over the space
+ *  - scan               sequential scan over the whole space
+ *  - loop[:LEN]         sequential loop over LEN pages (default vsize)
+ *  - phase[:SIZE[:LEN]] uniform over a working set of SIZE pages (default vsize / 16), moving every LEN accesses (default 100000)
+ */
+class Workload {
+public:
+    static constexpr size_t BLOCK = 1 << 16;
+
+    /**
+     * @brief Construct a new Workload object
+     *
+     * @param spec Mixture of patterns, see the class.
+     * @param num_vpages Number of virtual pages.
+     * @param seed Seed of the whole trace.
+     * @throw std::invalid_argument The spec is malformed.
+     */
+    Workload(const std::string& spec, pgidx_t num_vpages, uint64_t seed)
+        : _num_vpages(num_vpages)
+        , _seed(seed)
+    {
+        if (num_vpages == 0) {
+            throw std::invalid_argument("vsize");
+        }
+        _stride = 0x9e3779b1ull % num_vpages;
+        while (std::gcd<uint64_t>(_stride, num_vpages) != 1) {
+            ++_stride;
+        }
+        std::stringstream ss(spec);
+        std::string item;
+        double total = 0;
+        while (std::getline(ss, item, '+')) {
+            _parts.push_back(_parse(item));
+            total += _parts.back().weight;
+        }
+        if (_parts.empty() || !(total > 0)) {
+            throw std::invalid_argument(spec);
+        }
+        double acc = 0;
+        for (auto& p : _parts) {
+            acc += p.weight / total;
+            p.weight = acc; // Cumulative, to pick a part by one draw
+        }
+        _parts.back().weight = 1;
+    }
+
+    /**
+     * @brief Generate the accesses of a block.
+     *
+     * @param block Index of the block, covering accesses [block * BLOCK, (block + 1) * BLOCK).
+     * @param out Where the block is written.
+     * @param n Number of accesses, less than BLOCK for the last block.
+     */
+    void fill(size_t block, AccessSeq_t::value_type* out, size_t n) const
+    {
+        Rng rng(_seed, block);
+        size_t base = block * BLOCK;
+        for (size_t i = 0; i < n; ++i) {
+            const Part* part = &_parts[0];
+            if (_parts.size() > 1) {
+                double u = rng.uniform();
+                for (size_t k = 0; u >= part->weight && k + 1 < _parts.size(); ++k) {
+                    part = &_parts[k + 1];
+                }
+            }
+            out[i] = { _vpn(*part, base + i, rng), _type(rng) };
+        }
+    }
+
+    /**
+     * @brief Generate the whole trace on a number of threads.
+     */
+    AccessSeq_t generate(size_t num_ops, size_t jobs) const
+    {
+        AccessSeq_t ret(num_ops);
+        size_t num_blocks = (num_ops + BLOCK - 1) / BLOCK;
+        std::atomic<size_t> next { 0 };
+        auto worker = [&]() {
+            for (size_t b; (b = next++) < num_blocks;) {
+                fill(b, ret.data() + b * BLOCK, std::min(BLOCK, num_ops - b * BLOCK));
+            }
+        };
+        std::vector<std::thread> pool;
+        for (size_t j = 1; j < std::min(jobs, num_blocks); ++j) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : pool) {
+            t.join();
+        }
+        return ret;
+    }
+
+private:
+    enum Kind {
+        UNIFORM,
+        ZIPF,
+        SCAN,
+        LOOP,
+        PHASE,
+    };
+
+    struct Part {
+        Kind kind;
+        double weight = 1;
+        size_t size = 0; // Pages of the loop or the working set
+        size_t period = 0; // Accesses per phase
+        // Alias table of the Zipfian ranks, both halves of a slot together so a draw misses the cache once
+        std::vector<std::pair<double, pgidx_t>> alias;
+    };
+
+    // splitmix64 seeded xoshiro256**, the same everywhere unlike the std distributions
+    class Rng {
+    public:
+        Rng(uint64_t seed, uint64_t stream)
+        {
+            uint64_t x = seed ^ (stream * 0x9e3779b97f4a7c15ull);
+            for (auto& w : _s) {
+                w = _splitmix(x);
+            }
+        }
+
+        uint64_t next()
+        {
+            auto ret = _rotl(_s[1] * 5, 7) * 9;
+            auto t = _s[1] << 17;
+            _s[2] ^= _s[0];
+            _s[3] ^= _s[1];
+            _s[1] ^= _s[2];
+            _s[0] ^= _s[3];
+            _s[2] ^= t;
+            _s[3] = _rotl(_s[3], 45);
+            return ret;
+        }
+
+        // Uniform in [0, n)
+        uint64_t below(uint64_t n) { return uint64_t((unsigned __int128)next() * n >> 64); }
+
+        // Uniform in [0, 1)
+        double uniform() { return (next() >> 11) * 0x1.0p-53; }
+
+    private:
+        uint64_t _s[4];
+
+        static uint64_t _rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+        static uint64_t _splitmix(uint64_t& x)
+        {
+            uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+    };
+
+    pgidx_t _num_vpages;
+    uint64_t _seed;
+    uint64_t _stride; // Coprime with the number of pages
+    std::vector<Part> _parts;
+
+    Part _parse(const std::string& item) const
+    {
+        try {
+            return _parsePart(item);
+        } catch (std::logic_error&) { // Numbers rejected by std::stod / std::stoul
+            throw std::invalid_argument(item);
+        }
+    }
+
+    Part _parsePart(const std::string& item) const
+    {
+        Part ret;
+        auto spec = item;
+        auto at = spec.find('@');
+        if (at != std::string::npos) {
+            ret.weight = std::stod(spec.substr(at + 1));
+            spec = spec.substr(0, at);
+        }
+        std::vector<std::string> args;
+        std::stringstream ss(spec);
+        std::string arg;
+        while (std::getline(ss, arg, ':')) {
+            args.push_back(arg);
+        }
+        if (args.empty()) {
+            throw std::invalid_argument(item);
+        }
+        auto name = args[0];
+        if (name == "uniform" && args.size() == 1) {
+            ret.kind = UNIFORM;
+        } else if (name == "zipf" && args.size() <= 2) {
+            ret.kind = ZIPF;
+            _buildZipf(ret, args.size() > 1 ? std::stod(args[1]) : 1.0);
+        } else if (name == "scan" && args.size() == 1) {
+            ret.kind = SCAN;
+        } else if (name == "loop" && args.size() <= 2) {
+            ret.kind = LOOP;
+            ret.size = args.size() > 1 ? std::stoul(args[1]) : _num_vpages;
+        } else if (name == "phase" && args.size() <= 3) {
+            ret.kind = PHASE;
+            ret.size = args.size() > 1 ? std::stoul(args[1]) : std::max<size_t>(_num_vpages / 16, 1);
+            ret.period = args.size() > 2 ? std::stoul(args[2]) : 100000;
+        } else {
+            throw std::invalid_argument(item);
+        }
+        if (ret.weight < 0 || ((ret.kind == LOOP || ret.kind == PHASE) && (ret.size == 0 || ret.size > _num_vpages))
+            || (ret.kind == PHASE && ret.period == 0)) {
+            throw std::invalid_argument(item);
+        }
+        return ret;
+    }
+
+    // Vose's alias method, so a rank is drawn in O(1)
+    void _buildZipf(Part& part, double s) const
+    {
+        size_t n = _num_vpages;
+        std::vector<double> w(n);
+        double sum = 0;
+        for (size_t r = 0; r < n; ++r) {
+            sum += w[r] = 1.0 / std::pow(double(r + 1), s);
+        }
+        part.alias.resize(n);
+        std::vector<pgidx_t> small, large;
+        for (size_t r = 0; r < n; ++r) {
+            w[r] = w[r] * n / sum;
+            (w[r] < 1 ? small : large).push_back(r);
+        }
+        while (!small.empty() && !large.empty()) {
+            auto l = small.back(), g = large.back();
+            small.pop_back();
+            part.alias[l] = { w[l], g };
+            w[g] -= 1 - w[l];
+            if (w[g] < 1) {
+                large.pop_back();
+                small.push_back(g);
+            }
+        }
+        for (auto r : large) {
+            part.alias[r] = { 1, r };
+        }
+        for (auto r : small) {
+            part.alias[r] = { 1, r };
+        }
+    }
+
+    // Scatter the ranks over the space, so the hot pages are not all at the bottom.
+    // Both terms are below the number of pages, so the sum does not wrap and the map stays a bijection
+    pgidx_t _scatter(uint64_t r) const
+    {
+        return pgidx_t((_stride * r + _seed % _num_vpages) % _num_vpages);
+    }
+
+    pgidx_t _vpn(const Part& part, size_t pos, Rng& rng) const
+    {
+        switch (part.kind) {
+        case UNIFORM:
+            return pgidx_t(rng.below(_num_vpages));
+        case ZIPF: {
+            auto r = rng.below(_num_vpages);
+            auto& slot = part.alias[r];
+            return _scatter(rng.uniform() < slot.first ? r : slot.second);
+        }
+        case SCAN:
+            return pgidx_t(pos % _num_vpages);
+        case LOOP:
+            return pgidx_t(pos % part.size);
+        case PHASE: {
+            // The base of the working set of a phase only depends on the phase
+            Rng phase(_seed, ~uint64_t(pos / part.period));
+            auto base = phase.below(_num_vpages - part.size + 1);
+            return pgidx_t(base + rng.below(part.size));
+        }
+        }
+        return 0;
+    }
+
+    static pf_t _type(Rng& rng)
+    {
+        static constexpr pf_t types[] = { PF_READ, PF_WRITE, PF_EXEC, PF_RW, PF_RX };
+        return types[rng.below(5)];
+    }
+};
+
+#endif // WORKLOAD_HPP
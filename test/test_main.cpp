@@ -1,25 +1,31 @@
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
 
 #include "CmdArg.h"
 #include "SimulateProcess.hpp"
 #include "SimulateMemory.hpp"
+#include "FlatMemory.hpp"
+#include "TraceFile.hpp"
+#include "TraceStream.hpp"
 
-void summary(const SimulateMemory& memory, size_t num_ops)
+template <typename Memory>
+void summary(const Memory& memory, size_t num_ops)
 {
-    std::cout << "\n### Final Page Table\n"
-              << std::endl;
-    memory.dumpPageTable();
-    std::cout << "## Summary" << std::endl;
-    std::cout << "- Number of Page Faults on Read: " << memory.getNumPageFaultRead() << std::endl;
-    std::cout << "- Number of Page Faults on Write: " << memory.getNumPageFaultWrite() << std::endl;
-    std::cout << "- Number of Page Faults on Exec: " << memory.getNumPageFaultExec() << std::endl;
-    std::cout << "- Number of Page Faults: " << memory.getNumPageFault() << std::endl;
-    std::cout << "- Page Fault Rate: " << (double)memory.getNumPageFault() / num_ops << std::endl
+    std::cout << "## Summary\n"
+              << "- Number of Page Faults on Read: " << memory.getNumPageFaultRead() << "\n"
+              << "- Number of Page Faults on Write: " << memory.getNumPageFaultWrite() << "\n"
+              << "- Number of Page Faults on Exec: " << memory.getNumPageFaultExec() << "\n"
+              << "- Number of Page Faults: " << memory.getNumPageFault() << "\n"
+              << "- Page Fault Rate: " << (double)memory.getNumPageFault() / num_ops << "\n"
               << std::endl;
 }
 
@@ -27,12 +33,22 @@ void suit(const SimulateMemory& memory, AlgoBase* algo, const AccessSeq_t& acc)
 {
     std::cout << "## Test Details\n"
               << std::endl;
-    for (auto i = 0; i < acc.size(); i++) {
-        std::cout << "### Step " << i << "\n\nCurrent Page Table:" << std::endl;
-        memory.dumpPageTable();
-        algo->access(acc[i].first, acc[i].second);
-        std::cout << "\n---" << std::endl;
+    if (memory.getVerbosity() == VERBOSE_TRACE) {
+        size_t fed = 0;
+        for (auto i = 0; i < acc.size(); i++) {
+            std::cout << "### Step " << i << "\n\nCurrent Page Table:\n";
+            memory.dumpPageTable();
+            fed += algo->lookahead(AccessSpan_t(acc.data() + fed, acc.size() - fed));
+            algo->access(acc[i].first, acc[i].second);
+            std::cout << "\n---\n";
+        }
+    } else {
+        algo->accessBatch(acc);
+        algo->flush();
     }
+    std::cout << "\n### Final Page Table\n"
+              << std::endl;
+    memory.dumpPageTable();
     summary(memory, acc.size());
 }
 
@@ -103,10 +119,90 @@ void suit_optclock()
     suit(memory, &clock, acc);
 }
 
+// A policy with a short trace, and the faults worked out by hand for it
+struct SelfTest {
+    const char* name;
+    std::unique_ptr<AlgoBase> (*make)(SimulateMemory& memory);
+    const char* trace; // VPNs separated by spaces, a trailing 'w' for a write
+    size_t psize;
+    size_t faults;
+};
+
+const SelfTest selfTests[] = {
+    // Ghost hits in B1 and B2 move the target of T1 both ways
+    { "ARC", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoARC<SimulateMemory>>(&m, 10); },
+        "1 2 3 1 4 5 3 1 6 3 4 1", 3, 10 },
+    // A loop one page larger than the memory keeps its LIR pages, then a reused HIR page becomes LIR
+    { "LIRS", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoLIRS<SimulateMemory>>(&m, 10); },
+        "1 2 3 4 1 2 3 4 1 2 3 3 1", 3, 7 },
+    // The oldest ghost refaults while the victim's ghost makes room, and is still promoted to LIR
+    { "LIRS", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoLIRS<SimulateMemory>>(&m, 10); },
+        "1 2 3 4 5 6 3 7 3", 3, 8 },
+    // Cold pages reused within their test period are promoted
+    { "CLOCK-Pro", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoClockPro<SimulateMemory>>(&m, 10); },
+        "1 2 3 4 1 2 3 4 1 2 4 5 1 6 5", 3, 9 },
+    // A resident cold page reused within its test period grows the cold target
+    { "CLOCK-Pro", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoClockPro<SimulateMemory>>(&m, 10); },
+        "1 2 3 4 1 2 3 4 1 2 4 5 1 6 5 1", 3, 10 },
+    // A page reused within its test period while HAND_hot passes it is promoted, not expired
+    { "CLOCK-Pro", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoClockPro<SimulateMemory>>(&m, 10); },
+        "5 3 5 4 6 6 3 4 2 5", 3, 7 },
+    // A scan only flows through A1in, a refault from A1out reaches Am
+    { "2Q", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<Algo2Q<SimulateMemory>>(&m, 10); },
+        "1 2 3 4 5 1 1 6 3", 4, 8 },
+    // A refault of the oldest page of a full A1out still reaches Am
+    { "2Q", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<Algo2Q<SimulateMemory>>(&m, 10); },
+        "1 2 3 4 5 6 1 1 4 7 2 4 1 8 1", 4, 11 },
+    // A scan only flows through the probationary segment, a promotion pushes the LRU protected page back
+    { "SLRU", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoSLRU<SimulateMemory>>(&m, 0.5); },
+        "1 2 1 2 3 4 5 6 1 2 5 7 6 1", 4, 9 },
+    // The pages accessed once are evicted before the ones accessed more often
+    { "LFU", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoLFU<SimulateMemory>>(&m); },
+        "1 1 1 2 2 3 4 3 2 5 4", 3, 7 },
+    // An old dirty page is written back and skipped for an old clean one
+    { "WSClock", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoWSClock<SimulateMemory>>(&m, 1); },
+        "1w 2 3 4 1 5 2 1", 3, 6 },
+    // The smallest register goes, a reference between two ticks keeps a page
+    { "Aging", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoAging<SimulateMemory>>(&m, 2); },
+        "1 2 1 3 4 2 1 3 4", 3, 7 },
+    // The leading hand clears the bits two slots ahead of the trailing one
+    { "Two-handed Clock", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoTwoHandClock<SimulateMemory>>(&m, 2); },
+        "1 2 3 4 5 1 6 2 7 5 1 6", 4, 9 },
+    // Pages with less than two references go first, then the oldest second to last reference
+    { "LRU-K", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoLRUK<SimulateMemory>>(&m, 10, 2); },
+        "1 1 2 2 3 4 3 4 1 2", 3, 8 },
+    // The oldest remembered page refaults while the victim's history makes room, and keeps its references
+    { "LRU-K", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoLRUK<SimulateMemory>>(&m, 10, 2); },
+        "1 2 3 4 5 6 1 7 8 9 1", 3, 10 },
+    // With many samples of few frames, every fault finds the LRU frame
+    { "Sampled LRU", [](SimulateMemory& m) -> std::unique_ptr<AlgoBase> { return std::make_unique<AlgoSampledLRU<SimulateMemory>>(&m, 16, 16, 0); },
+        "1 2 3 1 4 2 5 1", 3, 7 },
+};
+
+// Run a self test, returning whether its faults are the expected ones
+bool suit(const SelfTest& test)
+{
+    AccessSeq_t acc;
+    std::istringstream iss(test.trace);
+    std::string vpn;
+    while (iss >> vpn) {
+        acc.push_back({ std::stoul(vpn), vpn.back() == 'w' ? PF_RW : PF_READ });
+    }
+    SimulateMemory memory(test.psize);
+    auto algo = test.make(memory);
+    suit(memory, algo.get(), acc);
+    bool ok = memory.getNumPageFault() == test.faults;
+    std::cout << "- Expected Page Faults: " << test.faults << (ok ? "" : " (MISMATCH)") << "\n"
+              << std::endl;
+    return ok;
+}
+
 auto modeStr = [](int mode) {
     switch (mode) {
     case MODE_OPT:
         return "OPT";
+    case MODE_OPTWINDOW:
+        return "OPT-W";
     case MODE_FIFO:
         return "FIFO";
     case MODE_LRU:
@@ -115,42 +211,452 @@ auto modeStr = [](int mode) {
         return "Clock";
     case MODE_OPTCLOCK:
         return "OptClock";
+    case MODE_ARC:
+        return "ARC";
+    case MODE_LIRS:
+        return "LIRS";
+    case MODE_CLOCKPRO:
+        return "CLOCK-Pro";
+    case MODE_2Q:
+        return "2Q";
+    case MODE_SLRU:
+        return "SLRU";
+    case MODE_LFU:
+        return "LFU";
+    case MODE_WSCLOCK:
+        return "WSClock";
+    case MODE_AGING:
+        return "Aging";
+    case MODE_CLOCK2:
+        return "Two-handed Clock";
+    case MODE_LRUK:
+        return "LRU-K";
+    case MODE_SAMPLED:
+        return "Sampled LRU";
     case MODE_ALL:
         return "All";
+    case MODE_MRC:
+        return "LRU Miss-Ratio Curve";
+    case MODE_SWEEP:
+        return "Sweep";
     default:
         return "Unknown";
     }
 };
 
-auto suit(ProgramMode mode, size_t psize, size_t vsize, const AccessSeq_t& acc)
+template <typename Memory>
+std::unique_ptr<AlgoBase> makeAlgo(const CmdArgParser& cmdarg, ProgramMode mode, Memory& memory, size_t vsize, const AccessSeq_t& acc)
 {
-    SimulateMemory memory(psize);
-    AlgoBase* algo = nullptr;
     switch (mode) {
     case MODE_OPT:
-        algo = new AlgoOPT(&memory, vsize, acc);
-        break;
+        return std::make_unique<AlgoOPT<Memory>>(&memory, vsize, acc);
+    case MODE_OPTWINDOW:
+        return std::make_unique<AlgoOPTWindow<Memory>>(&memory, vsize + 1, cmdarg.getWindow());
     case MODE_FIFO:
-        algo = new AlgoFIFO(&memory);
-        break;
+        return std::make_unique<AlgoFIFO<Memory>>(&memory);
     case MODE_LRU:
-        algo = new AlgoLRU(&memory);
-        break;
+        return std::make_unique<AlgoLRU<Memory>>(&memory);
     case MODE_CLOCK:
-        algo = new AlgoClock(&memory);
-        break;
+        return std::make_unique<AlgoClock<Memory>>(&memory);
     case MODE_OPTCLOCK:
-        algo = new AlgoOptClock(&memory);
-        break;
+        return std::make_unique<AlgoOptClock<Memory>>(&memory);
+    case MODE_ARC:
+        return std::make_unique<AlgoARC<Memory>>(&memory, vsize + 1);
+    case MODE_LIRS:
+        return std::make_unique<AlgoLIRS<Memory>>(&memory, vsize + 1);
+    case MODE_CLOCKPRO:
+        return std::make_unique<AlgoClockPro<Memory>>(&memory, vsize + 1);
+    case MODE_2Q:
+        return std::make_unique<Algo2Q<Memory>>(&memory, vsize + 1, cmdarg.getKin(), cmdarg.getKout());
+    case MODE_SLRU:
+        return std::make_unique<AlgoSLRU<Memory>>(&memory, cmdarg.getProtectedRatio());
+    case MODE_LFU:
+        return std::make_unique<AlgoLFU<Memory>>(&memory, cmdarg.getDecay());
+    case MODE_WSCLOCK:
+        return std::make_unique<AlgoWSClock<Memory>>(&memory, cmdarg.getTau());
+    case MODE_AGING:
+        switch (cmdarg.getAgeBits()) {
+        case 16:
+            return std::make_unique<AlgoAging<Memory, uint16_t>>(&memory, cmdarg.getTick());
+        case 32:
+            return std::make_unique<AlgoAging<Memory, uint32_t>>(&memory, cmdarg.getTick());
+        default:
+            return std::make_unique<AlgoAging<Memory, uint8_t>>(&memory, cmdarg.getTick());
+        }
+    case MODE_CLOCK2:
+        return std::make_unique<AlgoTwoHandClock<Memory>>(&memory, cmdarg.getSpread(), cmdarg.getAdvance());
+    case MODE_LRUK:
+        return std::make_unique<AlgoLRUK<Memory>>(&memory, vsize + 1, cmdarg.getLRUK(), cmdarg.getCRP(), cmdarg.getHistory());
+    case MODE_SAMPLED:
+        return std::make_unique<AlgoSampledLRU<Memory>>(&memory, cmdarg.getSamples(), cmdarg.getPool(), cmdarg.getSeed());
     default:
         std::cerr << "Unknown mode: " << mode << std::endl;
         exit(-3);
     }
+}
+
+using Result_t = std::tuple<size_t, size_t, size_t, size_t>; // PF, PF Read, PF Write, PF Exec
+
+// Accesses of a run: the decoded sequence, or a mapped trace replayed run by run when nothing needs it whole
+struct Input {
+    const AccessSeq_t& seq;
+    const TraceFile* trace = nullptr;
+
+    size_t size() const { return trace ? trace->size() : seq.size(); }
+
+    void replay(AlgoBase* algo) const
+    {
+        if (trace) {
+            trace->replay(algo);
+        } else {
+            algo->accessBatch(seq);
+            algo->flush();
+        }
+    }
+};
+
+// Per-algorithm details shared by every verbosity, the long ones only above silent
+template <typename Memory>
+void details(ProgramMode mode, Verbosity verbosity, AlgoBase* algo)
+{
+    if (mode == MODE_FIFO) {
+        auto fifo = static_cast<AlgoFIFO<Memory>*>(algo);
+        std::cout << "- Faults on Free Frames: " << fifo->getNumFreeLoads() << "\n"
+                  << "- Faults with Eviction: " << fifo->getNumEvictions() << "\n"
+                  << std::endl;
+    }
+    if (mode == MODE_ARC) {
+        auto arc = static_cast<AlgoARC<Memory>*>(algo);
+        std::cout << "- Final Recent / Frequent Pages (T1 / T2): " << arc->getRecentSize() << " / " << arc->getFrequentSize() << "\n"
+                  << "- Final Target Size of T1: " << arc->getTarget() << "\n"
+                  << std::endl;
+    }
+    if (mode == MODE_LIRS) {
+        auto lirs = static_cast<AlgoLIRS<Memory>*>(algo);
+        std::cout << "- Final LIR Pages: " << lirs->getNumLIR() << "\n"
+                  << "- Final Non-resident HIR Pages: " << lirs->getNumGhosts() << "\n"
+                  << std::endl;
+    }
+    if (mode == MODE_CLOCKPRO) {
+        auto clockpro = static_cast<AlgoClockPro<Memory>*>(algo);
+        std::cout << "- Final Hot Pages: " << clockpro->getNumHot() << "\n"
+                  << "- Final Target of Cold Pages: " << clockpro->getColdTarget() << "\n"
+                  << "- Final Non-resident Cold Pages: " << clockpro->getNumGhosts() << "\n"
+                  << std::endl;
+    }
+    if (mode == MODE_2Q) {
+        auto q2 = static_cast<Algo2Q<Memory>*>(algo);
+        std::cout << "- Final Pages in Am: " << q2->getNumHot() << "\n"
+                  << std::endl;
+    }
+    if (mode == MODE_SLRU) {
+        auto slru = static_cast<AlgoSLRU<Memory>*>(algo);
+        std::cout << "- Final Protected Pages: " << slru->getNumProtected() << "\n"
+                  << std::endl;
+    }
+    if (mode == MODE_LFU) {
+        auto lfu = static_cast<AlgoLFU<Memory>*>(algo);
+        std::cout << "- Final Distinct Counts: " << lfu->getNumBuckets() << "\n"
+                  << "- Count Halvings: " << lfu->getNumDecays() << "\n"
+                  << std::endl;
+    }
+    if (mode == MODE_CLOCK2) {
+        auto clock2 = static_cast<AlgoTwoHandClock<Memory>*>(algo);
+        auto evictions = clock2->getNumEvictions();
+        std::cout << "- Hand Spread: " << clock2->getSpread() << "\n"
+                  << "- Max Hand Travel per Fault: " << clock2->getMaxTravel() << " (bound: " << clock2->getSpread() + 1 << ")\n"
+                  << "- Avg Hand Travel per Fault: " << (evictions ? (double)clock2->getTotalTravel() / evictions : 0.0) << "\n"
+                  << "- Hand Travel off the Fault Path: " << clock2->getAdvanceTravel() << "\n"
+                  << std::endl;
+    }
+    if (mode == MODE_LRUK) {
+        auto lruk = static_cast<AlgoLRUK<Memory>*>(algo);
+        std::cout << "- Final Evicted Pages with History: " << lruk->getNumHistory() << "\n"
+                  << std::endl;
+    }
+    if (mode == MODE_SAMPLED) {
+        auto sampled = static_cast<AlgoSampledLRU<Memory>*>(algo);
+        std::cout << "- Victims from the Eviction Pool: " << sampled->getNumPoolHits() << "\n"
+                  << std::endl;
+    }
+    if (mode == MODE_WSCLOCK) {
+        auto wsclock = static_cast<AlgoWSClock<Memory>*>(algo);
+        auto& ws = wsclock->getWorkingSetSizes();
+        std::cout << "- Write-backs before Eviction: " << wsclock->getNumWriteBacks() << "\n"
+                  << "- Evictions of Dirty Pages: " << wsclock->getNumDirtyEvictions() << "\n";
+        if (!ws.empty()) {
+            size_t sum = 0;
+            for (auto size : ws) {
+                sum += size;
+            }
+            std::cout << "- Working Set Size (min / avg / max of " << ws.size() << " samples): " << *std::min_element(ws.begin(), ws.end())
+                      << " / " << (double)sum / ws.size() << " / " << *std::max_element(ws.begin(), ws.end()) << "\n";
+        }
+        std::cout << std::endl;
+        if (verbosity != VERBOSE_SILENT && !ws.empty()) {
+            std::cout << "### Working Set Size over Time\n\n"
+                      << "|Accesses|Working Set Size|\n"
+                      << "|---|---|\n";
+            for (size_t i = 0; i < ws.size(); ++i) {
+                std::cout << "|" << (i + 1) * wsclock->getTau() << "|" << ws[i] << "|\n";
+            }
+            std::cout << std::endl;
+        }
+    }
+}
+
+template <typename Memory>
+Result_t result(const Memory& memory)
+{
+    return Result_t { memory.getNumPageFault(), memory.getNumPageFaultRead(), memory.getNumPageFaultWrite(), memory.getNumPageFaultExec() };
+}
+
+// Faults of exact OPT, to compare an approximation with
+size_t optFaults(size_t psize, size_t vsize, const AccessSeq_t& acc)
+{
+    FlatMemory memory(psize, vsize + 1);
+    AlgoOPT<FlatMemory> opt(&memory, vsize + 1, acc);
+    opt.accessBatch(acc);
+    return memory.getNumPageFault();
+}
+
+// Faults of exact LRU, to compare an approximation with
+size_t lruFaults(size_t psize, size_t vsize, const Input& input)
+{
+    FlatMemory memory(psize, vsize + 1);
+    AlgoLRU<FlatMemory> lru(&memory);
+    input.replay(&lru);
+    return memory.getNumPageFault();
+}
+
+// lru is the result of exact LRU on the same input when it already ran, for the gap of Sampled LRU
+auto suit(const CmdArgParser& cmdarg, ProgramMode mode, size_t vsize, const Input& input, const Result_t* lru_ret = nullptr)
+{
+    auto& acc = input.seq;
     std::cout << "# " << modeStr(mode) << "\n"
               << std::endl;
-    suit(memory, algo, acc);
-    delete algo;
-    return std::tuple<size_t, size_t, size_t, size_t> { memory.getNumPageFault(), memory.getNumPageFaultRead(), memory.getNumPageFaultWrite(), memory.getNumPageFaultExec() };
+    Result_t ret;
+    if (cmdarg.getVerbosity() == VERBOSE_SILENT) {
+        // Nothing is formatted until the run is over
+        FlatMemory memory(cmdarg.getPSize(), vsize + 1);
+        auto algo = makeAlgo(cmdarg, mode, memory, vsize, acc);
+        input.replay(algo.get());
+        summary(memory, input.size());
+        details<FlatMemory>(mode, cmdarg.getVerbosity(), algo.get());
+        ret = result(memory);
+    } else {
+        SimulateMemory memory(cmdarg.getPSize(), cmdarg.getVerbosity());
+        auto algo = makeAlgo(cmdarg, mode, memory, vsize, acc);
+        suit(memory, algo.get(), acc);
+        details<SimulateMemory>(mode, cmdarg.getVerbosity(), algo.get());
+        ret = result(memory);
+    }
+    if (mode == MODE_OPTWINDOW) {
+        auto opt = optFaults(cmdarg.getPSize(), vsize, acc);
+        auto gap = std::get<0>(ret) - opt;
+        std::cout << "- Faults of exact OPT: " << opt << "\n"
+                  << "- Gap to exact OPT: " << gap << " (" << (opt ? 100.0 * gap / opt : 0.0) << "%)\n"
+                  << std::endl;
+    }
+    if (mode == MODE_SAMPLED) {
+        auto lru = lru_ret ? std::get<0>(*lru_ret) : lruFaults(cmdarg.getPSize(), vsize, input);
+        auto gap = (long long)std::get<0>(ret) - (long long)lru;
+        std::cout << "- Seed of the Sampling: " << cmdarg.getSeed() << "\n"
+                  << "- Faults of exact LRU: " << lru << "\n"
+                  << "- Gap to exact LRU: " << gap << " (" << (lru ? 100.0 * gap / lru : 0.0) << "%)\n"
+                  << std::endl;
+    }
+    return ret;
+}
+
+void summaryRow(const std::string& head, const Result_t& res, size_t num_ops)
+{
+    std::cout << "|" << head << "|" << std::get<0>(res) << "|" << std::get<1>(res) << "|" << std::get<2>(res) << "|" << std::get<3>(res)
+              << "|" << (double)std::get<0>(res) / num_ops << "|\n";
+}
+
+// Run every (algorithm, psize) cell on a pool of workers sharing the read-only sequence
+void sweep(const CmdArgParser& cmdarg, size_t vsize, const Input& input)
+{
+    std::vector<std::pair<ProgramMode, size_t>> cells;
+    for (auto psize : cmdarg.getPSizes()) {
+        for (auto mode : cmdarg.getAlgos()) {
+            cells.emplace_back(mode, psize);
+        }
+    }
+    std::vector<Result_t> results(cells.size());
+    std::atomic<size_t> next { 0 };
+    auto worker = [&]() {
+        for (size_t i; (i = next++) < cells.size();) {
+            FlatMemory memory(cells[i].second, vsize + 1);
+            auto algo = makeAlgo(cmdarg, cells[i].first, memory, vsize, input.seq);
+            input.replay(algo.get());
+            results[i] = result(memory);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t j = 0; j < std::min(cmdarg.getJobs(), cells.size()); ++j) {
+        pool.emplace_back(worker);
+    }
+    for (auto& t : pool) {
+        t.join();
+    }
+
+    std::cout << "# Sweep Summary\n"
+              << std::endl;
+    std::cout << "|Mode|PSize|PF|PF Read|PF Write|PF Exec|PF Rate|\n"
+                 "|---|---|---|---|---|---|---|\n";
+    for (size_t i = 0; i < cells.size(); ++i) {
+        summaryRow(std::string(modeStr(cells[i].first)) + "|" + std::to_string(cells[i].second), results[i], input.size());
+    }
+    std::cout << std::endl;
+}
+
+// Whether a run needs the accesses decoded whole: to look at all of them, or to print every step
+bool needsSeq(const CmdArgParser& cmdarg)
+{
+    auto mode = cmdarg.getMode();
+    if (mode == MODE_CONVERT || (cmdarg.getVerbosity() != VERBOSE_SILENT && mode != MODE_MRC && mode != MODE_SWEEP)) {
+        return true;
+    }
+    auto& algos = cmdarg.getAlgos();
+    auto needs = [](ProgramMode m) { return m == MODE_OPT || m == MODE_OPTWINDOW; };
+    return mode == MODE_ALL || mode == MODE_SWEEP ? std::any_of(algos.begin(), algos.end(), needs) : needs(mode);
+}
+
+// Simulate every (algorithm, psize) cell while the input is parsed, keeping only a few chunks of it
+// Check a mapped trace in one pass over the mapping, without decoding it
+std::string checkTrace(const TraceFile& trace, const std::string& path, size_t vsize)
+{
+    size_t total = 0;
+    pgidx_t max_vpn = 0;
+    bool ok = trace.forEachRun([&](const TraceFile::Run& run) {
+        total += run.count;
+        max_vpn = std::max(max_vpn, run.vpn);
+    });
+    if (!ok || total != trace.size()) {
+        return "Truncated trace file: " + path;
+    }
+    if (max_vpn > vsize) {
+        return "Invalid VPN: " + std::to_string(max_vpn);
+    }
+    return "";
+}
+
+int stream(const CmdArgParser& cmdarg)
+{
+    size_t vsize = cmdarg.getVSize();
+    TraceFile trace;
+    bool is_trace = !cmdarg.getInputFile().empty() && TraceFile::isTraceFile(cmdarg.getInputFile());
+    if (is_trace) {
+        auto err = trace.open(cmdarg.getInputFile());
+        if (!err.empty()) {
+            std::cerr << err << std::endl;
+            return -2;
+        }
+        if (vsize == 0) {
+            vsize = trace.header().num_vpages;
+        }
+        err = checkTrace(trace, cmdarg.getInputFile(), vsize);
+        if (!err.empty()) {
+            std::cerr << err << std::endl;
+            return -2;
+        }
+    } else if (vsize == 0) {
+        std::cerr << "Virtual memory size must be specified for " << (cmdarg.getNumOps() ? "random data" : "text input") << std::endl;
+        return -1;
+    }
+    std::unique_ptr<Workload> workload;
+    if (cmdarg.getNumOps()) {
+        try {
+            workload = std::make_unique<Workload>(cmdarg.getWorkload(), vsize, cmdarg.getSeed());
+        } catch (std::exception& e) {
+            std::cerr << "Invalid workload: " << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<ProgramMode> algos;
+    for (auto mode : cmdarg.getAlgos()) {
+        if (mode != MODE_OPT) {
+            algos.push_back(mode);
+        }
+    }
+    if (algos.empty()) {
+        std::cerr << "No algorithm to stream, OPT needs the whole trace" << std::endl;
+        return -1;
+    }
+    std::vector<std::pair<ProgramMode, size_t>> cells;
+    std::vector<std::unique_ptr<FlatMemory>> memories;
+    std::vector<std::unique_ptr<AlgoBase>> runs;
+    for (auto psize : cmdarg.getPSizes()) {
+        for (auto mode : algos) {
+            cells.emplace_back(mode, psize);
+            memories.push_back(std::make_unique<FlatMemory>(psize, vsize + 1));
+            runs.push_back(makeAlgo(cmdarg, mode, *memories.back(), vsize, AccessSeq_t {}));
+        }
+    }
+
+    size_t num_ops = 0;
+    ChunkPipeline pipe;
+    auto err = pipe.run(
+        [&](ChunkPipeline::Emit& emit) -> std::string {
+            if (workload) {
+                AccessSeq_t block(Workload::BLOCK);
+                for (size_t b = 0; b * Workload::BLOCK < cmdarg.getNumOps() && !emit.stopped(); ++b) {
+                    auto n = std::min(Workload::BLOCK, cmdarg.getNumOps() - b * Workload::BLOCK);
+                    workload->fill(b, block.data(), n);
+                    for (size_t i = 0; i < n; ++i) {
+                        emit(block[i].first, block[i].second);
+                    }
+                }
+                return "";
+            }
+            if (!is_trace) {
+                return readTextTrace(stdin, vsize, emit);
+            }
+            bool ok = trace.forEachRun([&](const TraceFile::Run& run) {
+                for (size_t n = run.count; n > 0 && !emit.stopped(); --n) {
+                    emit(run.vpn, run.access_type);
+                }
+            });
+            return ok ? "" : "Truncated trace file: " + cmdarg.getInputFile();
+        },
+        [&](AccessSpan_t chunk) {
+            for (auto& algo : runs) {
+                algo->accessBatch(chunk);
+            }
+            num_ops += chunk.size();
+            return true;
+        });
+    if (!err.empty()) {
+        std::cerr << err << std::endl;
+        return -2;
+    }
+    for (auto& algo : runs) {
+        algo->flush();
+    }
+
+    // clang-format off
+    std::cout << "---\n"
+                 "title: PgSub Test\n" <<
+                 "mode: " << modeStr(cmdarg.getMode()) << " (Stream)\n"
+                "vsize: " << vsize << "\n"
+                "psize: " << cmdarg.getPSize() << "\n" <<
+                (cmdarg.getNumOps() ? "gen: " + cmdarg.getWorkload() + "\nseed: " + std::to_string(cmdarg.getSeed()) + "\n" : std::string()) <<
+                "numops: " << num_ops << "\n"
+                 "---\n"
+              << std::endl;
+    // clang-format on
+    std::cout << "# Stream Summary\n"
+              << std::endl;
+    std::cout << "|Mode|PSize|PF|PF Read|PF Write|PF Exec|PF Rate|\n"
+                 "|---|---|---|---|---|---|---|\n";
+    for (size_t i = 0; i < cells.size(); ++i) {
+        summaryRow(std::string(modeStr(cells[i].first)) + "|" + std::to_string(cells[i].second), result(*memories[i]), num_ops);
+    }
+    std::cout << std::endl;
+    return 0;
 }
 
 int main(int argc, char* argv[])
@@ -186,16 +692,65 @@ int main(int argc, char* argv[])
         std::cout << "# Test OptClock\n"
                   << std::endl;
         suit_optclock();
+        bool ok = true;
+        for (const auto& test : selfTests) {
+            std::cout << "# Test " << test.name << " (P=" << test.psize << ")\n"
+                      << std::endl;
+            ok = suit(test) && ok;
+        }
+        if (!ok) {
+            std::cerr << "Page faults differ from the expected ones" << std::endl;
+            return -4;
+        }
         return 0;
     }
 
+    if (cmdarg.getStream()) {
+        return stream(cmdarg);
+    }
+
     AccessSeq_t acc;
+    TraceFile trace;
+    bool mapped = false;
+    size_t vsize = cmdarg.getVSize();
     if (cmdarg.getNumOps()) {
-        acc = SimulateProcess(cmdarg.getVSize()).random(cmdarg.getNumOps())();
+        if (vsize == 0) {
+            std::cerr << "Virtual memory size must be specified for random data" << std::endl;
+            exit(-1);
+        }
+        try {
+            acc = SimulateProcess(vsize).workload(cmdarg.getWorkload(), cmdarg.getNumOps(), cmdarg.getSeed(), cmdarg.getJobs())();
+        } catch (std::exception& e) {
+            std::cerr << "Invalid workload: " << e.what() << std::endl;
+            exit(-1);
+        }
+    } else if (!cmdarg.getInputFile().empty() && TraceFile::isTraceFile(cmdarg.getInputFile())) {
+        auto err = trace.open(cmdarg.getInputFile());
+        if (!err.empty()) {
+            std::cerr << err << std::endl;
+            exit(-2);
+        }
+        if (vsize == 0) {
+            vsize = trace.header().num_vpages;
+        }
+        err = checkTrace(trace, cmdarg.getInputFile(), vsize);
+        if (!err.empty()) {
+            std::cerr << err << std::endl;
+            exit(-2);
+        }
+        mapped = true;
+        if (needsSeq(cmdarg)) {
+            acc = trace.toSeq();
+            mapped = false;
+        }
     } else {
+        if (vsize == 0) {
+            std::cerr << "Virtual memory size must be specified for text input" << std::endl;
+            exit(-1);
+        }
         pgidx_t vpn, access_type;
         while (std::cin >> vpn >> access_type) {
-            if (vpn > cmdarg.getVSize()) {
+            if (vpn > vsize) {
                 std::cerr << "Invalid VPN: " << vpn << std::endl;
                 exit(-2);
             }
@@ -207,34 +762,69 @@ int main(int argc, char* argv[])
         }
     }
 
+    if (cmdarg.getMode() == MODE_CONVERT) {
+        auto err = TraceFile::write(cmdarg.getConvertFile(), acc, vsize,
+            cmdarg.getCompress() ? TraceFile::ENCODING_RUN_DELTA : TraceFile::ENCODING_PACKED);
+        if (!err.empty()) {
+            std::cerr << err << std::endl;
+            exit(-2);
+        }
+        std::cerr << "Converted " << acc.size() << " accesses to " << cmdarg.getConvertFile() << std::endl;
+        return 0;
+    }
+
+    Input input { acc, mapped ? &trace : nullptr };
+
     // clang-format off
     std::cout << "---\n"
                  "title: PgSub Test\n" <<
                  "mode: " << modeStr(cmdarg.getMode()) << "\n"
-                "vsize: " << cmdarg.getVSize() << "\n"
-                "psize: " << cmdarg.getPSize() << "\n"
-                "numops: " << acc.size() << "\n"
+                "vsize: " << vsize << "\n"
+                "psize: " << cmdarg.getPSize() << "\n" <<
+                (cmdarg.getNumOps() ? "gen: " + cmdarg.getWorkload() + "\nseed: " + std::to_string(cmdarg.getSeed()) + "\n" : std::string()) <<
+                "numops: " << input.size() << "\n"
                  "---\n"
               << std::endl;
     // clang-format on
-    if (cmdarg.getMode() == MODE_ALL) {
-        auto opt = suit(MODE_OPT, cmdarg.getPSize(), cmdarg.getVSize(), acc);
-        auto fifo = suit(MODE_FIFO, cmdarg.getPSize(), cmdarg.getVSize(), acc);
-        auto lru = suit(MODE_LRU, cmdarg.getPSize(), cmdarg.getVSize(), acc);
-        auto clock = suit(MODE_CLOCK, cmdarg.getPSize(), cmdarg.getVSize(), acc);
-        auto optclock = suit(MODE_OPTCLOCK, cmdarg.getPSize(), cmdarg.getVSize(), acc);
+    if (cmdarg.getMode() == MODE_MRC) {
+        LRUStackDistance mrc(vsize + 1);
+        if (mapped) {
+            trace.forEachRun([&](const TraceFile::Run& run) {
+                for (size_t n = run.count; n > 0; --n) {
+                    mrc.access(run.vpn);
+                }
+            });
+        } else {
+            mrc.access(acc);
+        }
+        auto faults = mrc.getFaults();
+        std::cout << "# " << modeStr(MODE_MRC) << "\n\n"
+                  << "|PSize|PF|PF Rate|\n"
+                     "|---|---|---|\n";
+        for (size_t p = 1; p <= vsize; ++p) {
+            std::cout << "|" << p << "|" << faults[p - 1] << "|" << (double)faults[p - 1] / input.size() << "|\n";
+        }
+        std::cout << std::endl;
+    } else if (cmdarg.getMode() == MODE_SWEEP) {
+        sweep(cmdarg, vsize, input);
+    } else if (cmdarg.getMode() == MODE_ALL) {
+        auto& algos = cmdarg.getAlgos();
+        auto lru = size_t(std::find(algos.begin(), algos.end(), MODE_LRU) - algos.begin());
+        std::vector<Result_t> results;
+        results.reserve(algos.size());
+        for (auto mode : algos) {
+            results.push_back(suit(cmdarg, mode, vsize, input, lru < results.size() ? &results[lru] : nullptr));
+        }
         std::cout << "# Total Summary\n"
                   << std::endl;
         std::cout << "|Mode|PF|PF Read|PF Write|PF Exec|PF Rate|\n"
-                     "|---|---|---|---|---|---|\n"
-                  << "|OPT|" << std::get<0>(opt) << "|" << std::get<1>(opt) << "|" << std::get<2>(opt) << "|" << std::get<3>(opt) << "|" << (double)std::get<0>(opt) / acc.size() << "|\n"
-                  << "|FIFO|" << std::get<0>(fifo) << "|" << std::get<1>(fifo) << "|" << std::get<2>(fifo) << "|" << std::get<3>(fifo) << "|" << (double)std::get<0>(fifo) / acc.size() << "|\n"
-                  << "|LRU|" << std::get<0>(lru) << "|" << std::get<1>(lru) << "|" << std::get<2>(lru) << "|" << std::get<3>(lru) << "|" << (double)std::get<0>(lru) / acc.size() << "|\n"
-                  << "|Clock|" << std::get<0>(clock) << "|" << std::get<1>(clock) << "|" << std::get<2>(clock) << "|" << std::get<3>(clock) << "|" << (double)std::get<0>(clock) / acc.size() << "|\n"
-                  << "|OptClock|" << std::get<0>(optclock) << "|" << std::get<1>(optclock) << "|" << std::get<2>(optclock) << "|" << std::get<3>(optclock) << "|" << (double)std::get<0>(optclock) / acc.size() << "|\n"
-                  << std::endl;
+                     "|---|---|---|---|---|---|\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            summaryRow(modeStr(cmdarg.getAlgos()[i]), results[i], input.size());
+        }
+        std::cout << std::endl;
     } else {
-        suit(cmdarg.getMode(), cmdarg.getPSize(), cmdarg.getVSize(), acc);
+        suit(cmdarg, cmdarg.getMode(), vsize, input);
     }
     return 0;
 }
\ No newline at end of file